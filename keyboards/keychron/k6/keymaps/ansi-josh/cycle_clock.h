@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include "ch.h"
+
+// The SN32F248B is a Cortex-M0, which has no DWT cycle counter. Timestamps
+// come from the ChibiOS system tick plus how far SysTick has counted down
+// into the current tick, so they are in CPU cycles and wrap every ~89s at
+// 48MHz. Only take differences between them, and the wrap is harmless.
+//
+// That needs the periodic tick: in tickless mode the system time no longer
+// advances once per SysTick reload.
+#if CH_CFG_ST_TIMEDELTA != 0
+#  error "cycle_clock.h needs the periodic system tick (CH_CFG_ST_TIMEDELTA 0)"
+#endif
+
+// And a 32-bit system time, so ticks * (LOAD + 1) wraps the same way.
+_Static_assert(sizeof(systime_t) == 4, "cycle_clock.h needs a 32-bit systime_t");
+
+static inline uint32_t cycle_clock_now(void) {
+  uint32_t ticks;
+  uint32_t counter;
+
+  do {
+    ticks   = chVTGetSystemTimeX();
+    counter = SysTick->VAL;
+  } while (ticks != chVTGetSystemTimeX());
+
+  return ticks * (SysTick->LOAD + 1) + (SysTick->LOAD - counter);
+}
+
+// CPU cycles per second, as the clock counts them.
+static inline uint32_t cycle_clock_frequency(void) {
+  return (SysTick->LOAD + 1) * CH_CFG_ST_FREQUENCY;
+}
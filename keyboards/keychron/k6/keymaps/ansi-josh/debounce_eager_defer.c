@@ -0,0 +1,100 @@
+#include QMK_KEYBOARD_H
+#include "debounce.h"
+
+// Per-key debounce, eager on press and deferred on release:
+//
+// - A press is reported on the first scan that sees it, then the key is
+//   locked for DEBOUNCE ms so contact bounce can't release it.
+// - A release is only reported once the switch has read open for DEBOUNCE ms
+//   in a row. Any bounce back closed cancels it.
+//
+// Each key gets a 4-bit state, two keys to a byte: bit 3 marks a pending
+// release and bits 0-2 count down the remaining ms.
+
+#ifndef DEBOUNCE
+#  define DEBOUNCE 5
+#endif
+
+_Static_assert(DEBOUNCE > 0 && DEBOUNCE <= 7, "eager_defer debounce keeps a 3-bit countdown per key");
+
+#define KEY_COUNT       (MATRIX_ROWS * MATRIX_COLS)
+#define RELEASE_PENDING 0x8
+#define COUNTDOWN_MASK  0x7
+
+static uint8_t  key_states[(KEY_COUNT + 1) / 2];
+static uint16_t last_time;
+static bool     counting;
+
+static uint8_t get_state(uint16_t key) {
+  return (key_states[key / 2] >> ((key & 1) * 4)) & 0xF;
+}
+
+static void set_state(uint16_t key, uint8_t state) {
+  uint8_t shift = (key & 1) * 4;
+  key_states[key / 2] = (key_states[key / 2] & ~(0xF << shift)) | (state << shift);
+}
+
+void debounce_init(uint8_t num_rows) {
+  memset(key_states, 0, sizeof(key_states));
+  last_time = timer_read();
+  counting  = false;
+}
+
+bool debounce_active(void) {
+  return counting;
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+  uint16_t now     = timer_read();
+  uint16_t elapsed = TIMER_DIFF_16(now, last_time);
+  last_time        = now;
+
+  // Nothing moved and nothing is counting down: cooked already matches raw.
+  if (!changed && !counting) {
+    return;
+  }
+
+  counting = false;
+
+  for (uint8_t row = 0; row < num_rows; row++) {
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+      uint16_t     key       = row * MATRIX_COLS + col;
+      matrix_row_t mask      = (matrix_row_t)1 << col;
+      bool         raw_on    = raw[row] & mask;
+      uint8_t      state     = get_state(key);
+      uint8_t      countdown = state & COUNTDOWN_MASK;
+      bool         releasing = state & RELEASE_PENDING;
+
+      if (countdown) {
+        countdown = countdown > elapsed ? countdown - elapsed : 0;
+
+        if (releasing && raw_on) {
+          countdown = 0;
+          releasing = false;
+        } else if (releasing && countdown == 0) {
+          cooked[row] &= ~mask;
+          releasing = false;
+        }
+      }
+
+      if (countdown == 0 && !releasing) {
+        bool cooked_on = cooked[row] & mask;
+
+        if (raw_on && !cooked_on) {
+          cooked[row] |= mask;
+          countdown = DEBOUNCE;
+        } else if (!raw_on && cooked_on) {
+          countdown = DEBOUNCE;
+          releasing = true;
+        }
+      }
+
+      set_state(key, countdown | (releasing ? RELEASE_PENDING : 0));
+      if (countdown) {
+        counting = true;
+      }
+    }
+  }
+}
+
+void debounce_free(void) {}
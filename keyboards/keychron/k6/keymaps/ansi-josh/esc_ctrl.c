@@ -0,0 +1,55 @@
+#include QMK_KEYBOARD_H
+#include "esc_ctrl.h"
+
+// Esc on tap, Ctrl on hold:
+//
+// - Pressing the key sends nothing yet.
+// - The first other key pressed while it is down makes it Ctrl straight
+//   away, before that key is processed. Ctrl goes out in its own report
+//   first, so it reaches the host even when that key sends nothing, as a
+//   layer key doesn't.
+// - Held alone for ESC_CTRL_TAP_TERM ms, it turns into Ctrl then, so
+//   Ctrl-click works without another key.
+// - Released before that with nothing else pressed, it sends Esc right then.
+typedef enum {
+  ESC_CTRL_IDLE,
+  ESC_CTRL_PENDING,
+  ESC_CTRL_HOLDING,
+} esc_ctrl_state_t;
+
+static esc_ctrl_state_t state;
+static uint16_t         press_time;
+
+void esc_ctrl_press(void) {
+  state      = ESC_CTRL_PENDING;
+  press_time = timer_read();
+}
+
+void esc_ctrl_release(void) {
+  // The tap term may have run out since the task last looked, so the
+  // release sees the same Ctrl the task would have registered.
+  esc_ctrl_task();
+
+  if (state == ESC_CTRL_PENDING) {
+    tap_code(KC_ESC);
+  } else if (state == ESC_CTRL_HOLDING) {
+    unregister_mods(MOD_BIT(KC_LCTL));
+  }
+
+  state = ESC_CTRL_IDLE;
+}
+
+// Called for every other key press.
+void esc_ctrl_interrupt(void) {
+  if (state == ESC_CTRL_PENDING) {
+    register_mods(MOD_BIT(KC_LCTL));
+    state = ESC_CTRL_HOLDING;
+  }
+}
+
+void esc_ctrl_task(void) {
+  if (state == ESC_CTRL_PENDING && timer_elapsed(press_time) >= ESC_CTRL_TAP_TERM) {
+    register_mods(MOD_BIT(KC_LCTL));
+    state = ESC_CTRL_HOLDING;
+  }
+}
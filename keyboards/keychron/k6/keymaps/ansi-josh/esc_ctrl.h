@@ -0,0 +1,14 @@
+#pragma once
+
+#include "quantum.h"
+
+// A solo press released within this many ms sends Esc. Held longer, it
+// turns into Ctrl on its own so Ctrl-click works without another key.
+#ifndef ESC_CTRL_TAP_TERM
+#  define ESC_CTRL_TAP_TERM 200
+#endif
+
+void esc_ctrl_press(void);
+void esc_ctrl_release(void);
+void esc_ctrl_interrupt(void);
+void esc_ctrl_task(void);
@@ -0,0 +1,82 @@
+#include QMK_KEYBOARD_H
+#include "key_trace.h"
+
+_Static_assert(MATRIX_ROWS <= 8 && MATRIX_COLS <= 16, "key_trace packs row and col into one byte");
+_Static_assert(sizeof(key_trace_event_t) == 4, "key_trace_event_t must stay 4 bytes");
+
+static key_trace_event_t events[KEY_TRACE_SIZE];
+static uint16_t          next_event;
+static uint16_t          event_count;
+static uint32_t          last_time;
+
+void key_trace_record(keyrecord_t *record) {
+  uint32_t now   = timer_read32();
+  uint32_t delta = event_count ? now - last_time : 0;
+
+  events[next_event] = (key_trace_event_t){
+    .delta = delta < UINT16_MAX ? delta : UINT16_MAX,
+    .key   = (record->event.pressed ? 0x80 : 0) | (record->event.key.row << 4) | record->event.key.col,
+    .mods  = get_mods(),
+  };
+
+  last_time  = now;
+  next_event = (next_event + 1) % KEY_TRACE_SIZE;
+  if (event_count < KEY_TRACE_SIZE) {
+    event_count++;
+  }
+}
+
+// Prints the trace to the console as hex lines prefixed with "TRC ", ending
+// with "TRC END". Joined back together they form a trace file:
+//
+//   "K6TR"  magic
+//   u8      version (1)
+//   u16     event count
+//   events  oldest first, 4 bytes each as in key_trace_event_t
+//
+// All integers are little-endian. scripts/key-trace.py does the joining.
+#define DUMP_LINE_BYTES 32
+
+static char    dump_line[DUMP_LINE_BYTES * 2 + 1];
+static uint8_t dump_length;
+
+static void dump_byte(uint8_t byte) {
+  static const char hex[] = "0123456789ABCDEF";
+
+  dump_line[dump_length * 2]     = hex[byte >> 4];
+  dump_line[dump_length * 2 + 1] = hex[byte & 0xF];
+
+  if (++dump_length == DUMP_LINE_BYTES) {
+    dump_line[DUMP_LINE_BYTES * 2] = '\0';
+    uprintf("TRC %s\n", dump_line);
+    dump_length = 0;
+  }
+}
+
+void key_trace_dump(void) {
+  uint16_t first = (next_event + KEY_TRACE_SIZE - event_count) % KEY_TRACE_SIZE;
+
+  dump_length = 0;
+  dump_byte('K');
+  dump_byte('6');
+  dump_byte('T');
+  dump_byte('R');
+  dump_byte(1);
+  dump_byte(event_count);
+  dump_byte(event_count >> 8);
+
+  for (uint16_t i = 0; i < event_count; i++) {
+    const key_trace_event_t *event = &events[(first + i) % KEY_TRACE_SIZE];
+
+    dump_byte(event->delta);
+    dump_byte(event->delta >> 8);
+    dump_byte(event->key);
+    dump_byte(event->mods);
+  }
+
+  if (dump_length) {
+    dump_line[dump_length * 2] = '\0';
+    uprintf("TRC %s\n", dump_line);
+  }
+  uprintf("TRC END\n");
+}
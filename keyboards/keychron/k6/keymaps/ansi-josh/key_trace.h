@@ -0,0 +1,19 @@
+#pragma once
+
+#include "quantum.h"
+
+// Number of events kept; the oldest are overwritten once it fills up.
+#ifndef KEY_TRACE_SIZE
+#  define KEY_TRACE_SIZE 256
+#endif
+
+// One recorded event, 4 bytes. Timestamps are deltas so a whole typing
+// session fits without needing absolute times.
+typedef struct {
+  uint16_t delta; // ms since the previous event, saturated at 0xFFFF
+  uint8_t  key;   // bit 7: pressed, bits 4-6: row, bits 0-3: col
+  uint8_t  mods;  // get_mods() as process_record_user saw them
+} key_trace_event_t;
+
+void key_trace_record(keyrecord_t *record);
+void key_trace_dump(void);
@@ -15,30 +15,85 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include QMK_KEYBOARD_H
+#include "debounce.h"
+#include "mod_override.h"
+#include "esc_ctrl.h"
+#include "rgb_cache.h"
+#include "scan_governor.h"
+
+#ifdef K6_FN_LAYER_OVERLAYS
+#  include "sparse_keymap.h"
+#endif
+#ifdef RGB_MATRIX_ENABLE
+#  include "layer_leds.h"
+#endif
+#ifdef LATENCY_STATS_ENABLE
+#  include "latency_stats.h"
+#endif
+#ifdef KEY_TRACE_ENABLE
+#  include "key_trace.h"
+#endif
 
 // Each layer gets a name for readability, which is then used in the keymap
 // matrix below. The underscores don't mean anything - you can have a layer
 // called STUFF or any other name. Layer names don't all need to be of the
 // same length, obviously, and you can also skip them entirely and just use
 // numbers.
+//
+// The base layers come first. The FN layers are written as sparse overlays
+// below and expanded into full layers for the firmware.
+//
+// Building with K6_OS = mac or K6_OS = windows (see rules.mk) leaves out the
+// other OS's layers entirely, and with them the Mac/Win dip switch handling.
+#if defined(_K6_MAC) && defined(_K6_WINDOWS)
+#  error "Set K6_OS to one of both, mac or windows"
+#endif
+#ifndef _K6_WINDOWS
+#  define K6_MAC_LAYERS
+#endif
+#ifndef _K6_MAC
+#  define K6_WIN_LAYERS
+#endif
+
 enum layer_names {
-    _MAC_BASE = 0,
+#ifdef K6_MAC_LAYERS
+    _MAC_BASE,
+#endif
+#ifdef K6_WIN_LAYERS
+    _WIN_BASE,
+#endif
+#ifdef K6_MAC_LAYERS
     _MAC_FN1,
     _MAC_FN2,
-    _WIN_BASE,
+#endif
+#ifdef K6_WIN_LAYERS
     _WIN_FN1,
     _WIN_FN2,
+#endif
 };
 
+// Layers below this are the base layers, the rest are FN layers.
+#if defined(K6_MAC_LAYERS) && defined(K6_WIN_LAYERS)
+#  define FN_LAYERS_START 2
+#else
+#  define FN_LAYERS_START 1
+#endif
+
 // Custom keykodes
 enum my_keycodes {
-  MAC_EXPOSE = SAFE_RANGE
+  MAC_EXPOSE = SAFE_RANGE,
+  ESC_CTRL,
+#ifdef KEY_TRACE_ENABLE
+  KEY_TRACE_DUMP,
+#endif
 };
 
 // https://beta.docs.qmk.fm/using-qmk/simple-keycodes/keycodes
 
+// Base layers. These are mostly populated, so they stay dense.
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 
+#ifdef K6_MAC_LAYERS
 /**
  * macOS Main Layer
  *
@@ -48,7 +103,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
  *
  * This diverges from the main K6 macOS layout by remapping:
  *
- * - Caps Lock => Escape
+ * - Caps Lock => Escape on tap, Ctrl when held or pressed with another key
  * - Esc => Grave/Tilde
  *
  * ┌───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───────┬───┐
@@ -72,11 +127,61 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
   // 0,    1,       2,       3,     4,     5,     6,      7,     8,     9,       10,      11,           12,           13,        14,      15
   KC_GRV,  KC_1,    KC_2,    KC_3,  KC_4,  KC_5,  KC_6,   KC_7,  KC_8,  KC_9,    KC_0,    KC_MINS,      KC_EQL,       KC_BSPC,            RGB_MOD,
   KC_TAB,  KC_Q,    KC_W,    KC_E,  KC_R,  KC_T,  KC_Y,   KC_U,  KC_I,  KC_O,    KC_P,    KC_LBRC,      KC_RBRC,      KC_BSLASH,          KC_HOME,
-  KC_ESC,  KC_A,    KC_S,    KC_D,  KC_F,  KC_G,  KC_H,   KC_J,  KC_K,  KC_L,    KC_SCLN, KC_QUOT,                    KC_ENT,             KC_PGUP,
+  ESC_CTRL, KC_A,   KC_S,    KC_D,  KC_F,  KC_G,  KC_H,   KC_J,  KC_K,  KC_L,    KC_SCLN, KC_QUOT,                    KC_ENT,             KC_PGUP,
   KC_LSFT,          KC_Z,    KC_X,  KC_C,  KC_V,  KC_B,   KC_N,  KC_M,  KC_COMM, KC_DOT,  KC_SLSH,                    KC_RSFT,   KC_UP,   KC_PGDOWN,
   KC_LCTL, KC_LALT, KC_LGUI,                      KC_SPC,                        KC_RGUI, MO(_MAC_FN1), MO(_MAC_FN2), KC_LEFT,   KC_DOWN, KC_RGHT
 ),
+#endif
+
+#ifdef K6_WIN_LAYERS
+/**
+ * Windows Main Layer
+ *
+ * Caps Lock is Escape on tap and Ctrl when held, like on macOS.
+ *
+ * ┌───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───────┬───┐
+ * │ ` │ 1 │ 2 │ 3 │ 4 │ 5 │ 6 │ 7 │ 8 │ 9 │ 0 │ - │ + │ BKSPC │KLC│
+ * ├───┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─────┼───┤
+ * │ TAB │ Q │ W │ E │ R │ T │ Y │ U │ I │ O │ P │ [ │ ] │  \  │HOM│
+ * ├─────┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴─────┼───┤    
+ * │ ESC  │ A │ S │ D │ F │ G │ H │ J │ K │ L │ ; │ ' │ ENTER  │PUP│
+ * ├──────┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴────┬───┼───┤
+ * │ LSHIFT │ Z │ X │ C │ V │ B │ N │ M │ , │ . │ - │RSHIFT│UP │PDN│
+ * ├────┬───┴┬──┴─┬─┴───┴───┴───┴───┴───┴──┬┴──┬┴──┬┴──┬───┼───┼───┤
+ * │CTRL│WIN │ALT │                        │CTL│FN1│FN2│LFT│DWN│RGT│
+ * └────┴────┴────┴────────────────────────┴───┴───┴───┴───┴───┴───┘
+ *
+ * KLC - Keyboard RGB mode cycle
+ * HOM - Home
+ * PUP - Page Up
+ * PDN - Page Down
+ */
+[_WIN_BASE] = LAYOUT_65_ansi(
+  // 0,    1,       2,       3,    4,    5,    6,      7,    8,    9,       10,       11,           12,           13,        14,      15
+  KC_ESC,  KC_1,    KC_2,    KC_3, KC_4, KC_5, KC_6,   KC_7, KC_8, KC_9,    KC_0,     KC_MINS,      KC_EQL,       KC_BSPC,            RGB_MOD,
+  KC_TAB,  KC_Q,    KC_W,    KC_E, KC_R, KC_T, KC_Y,   KC_U, KC_I, KC_O,    KC_P,     KC_LBRC,      KC_RBRC,      KC_BSLASH,          KC_HOME,
+  ESC_CTRL, KC_A,   KC_S,    KC_D, KC_F, KC_G, KC_H,   KC_J, KC_K, KC_L,    KC_SCLN,  KC_QUOT,                    KC_ENT,             KC_PGUP,
+  KC_LSFT,          KC_Z,    KC_X, KC_C, KC_V, KC_B,   KC_N, KC_M, KC_COMM, KC_DOT,   KC_SLSH,                    KC_RSFT,   KC_UP,   KC_PGDOWN,
+  KC_LCTL, KC_LGUI, KC_LALT,                   KC_SPC,                      KC_RCTRL, MO(_WIN_FN1), MO(_WIN_FN2), KC_LEFT,   KC_DOWN, KC_RGHT
+),
+#endif
+
+// The FN layers in full, generated from the overlays below by
+// scripts/gen-fn-layers.py. KC_TRNS is already resolved, so every layer
+// state has a table QMK reads directly and its layer walk stops at the top.
+#include "fn_layers.inc"
 
+};
+
+// FN layers. Outside of the top row they are almost entirely KC_NO, so only
+// the keys that do something are listed, in LAYOUT_65_ansi order.
+//
+// These are the source for fn_layers.inc, so run scripts/gen-fn-layers.py
+// after changing one. The firmware only has the generated layers; the host
+// tests build these with K6_FN_LAYER_OVERLAYS to check them against it.
+#ifdef K6_FN_LAYER_OVERLAYS
+
+#ifdef K6_MAC_LAYERS
 /**
  * macOS FN1 Layer
  *
@@ -130,16 +235,20 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
  * KHU - Keyboard RGB hue increase
  * KHD - Keyboard RGB hue decrease
  *
- * TODO: Is RGB_TOG okay since it writes to EEPROM?
+ * RGB changes are only saved to EEPROM once the RGB keys have been left
+ * alone for a few seconds, see rgb_cache.c.
  */
-[_MAC_FN1] = LAYOUT_65_ansi(
-  // 0,    1,       2,       3,          4,      5,       6,       7,       8,       9,       10,      11,      12,      13,      14,      15
-  KC_ESC,  KC_F14,  KC_F15,  MAC_EXPOSE, KC_F16, RGB_VAD, RGB_VAI, KC_MPRV, KC_MPLY, KC_MNXT, KC_MUTE, KC_VOLD, KC_VOLU, KC_DEL,           RGB_TOG,
-  KC_NO,   KC_NO,   KC_NO,   KC_NO,      KC_NO,  KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_INS,  KC_DEL,  KC_END,  KC_NO,            KC_NO,
-  KC_CAPS, KC_NO,   KC_NO,   KC_NO,      KC_NO,  KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,            KC_NO,            KC_NO,
-  KC_TRNS,          KC_NO,   KC_NO,      KC_NO,  KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,            KC_TRNS, RGB_SAI, KC_NO,
-  KC_TRNS, KC_TRNS, KC_TRNS,                              RESET,                              KC_TRNS, KC_NO,   KC_NO,   RGB_HUD, RGB_SAD, RGB_HUI
-),
+static const sparse_key_t PROGMEM mac_fn1_keys[] = {
+  {POS_ESC,  KC_ESC},  {POS_1,    KC_F14},  {POS_2,    KC_F15},  {POS_3,    MAC_EXPOSE}, {POS_4,    KC_F16},
+  {POS_5,    RGB_VAD}, {POS_6,    RGB_VAI}, {POS_7,    KC_MPRV}, {POS_8,    KC_MPLY},    {POS_9,    KC_MNXT},
+  {POS_0,    KC_MUTE}, {POS_MINS, KC_VOLD}, {POS_EQL,  KC_VOLU}, {POS_BSPC, KC_DEL},     {POS_LIGHT, RGB_TOG},
+  {POS_P,    KC_INS},  {POS_LBRC, KC_DEL},  {POS_RBRC, KC_END},
+  {POS_CAPS, KC_CAPS},
+  {POS_LSFT, KC_TRNS}, {POS_RSFT, KC_TRNS}, {POS_UP,   RGB_SAI},
+  {POS_LCTL, KC_TRNS}, {POS_LALT, KC_TRNS}, {POS_LGUI, KC_TRNS}, {POS_SPC,  RESET},      {POS_RGUI, KC_TRNS},
+  {POS_LEFT, RGB_HUD}, {POS_DOWN, RGB_SAD}, {POS_RGHT, RGB_HUI}
+};
+#endif
 
 /**
  * macOS FN2 Layer
@@ -147,6 +256,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
  * This layer includes standard F1-F12 keys present on the K6.
  *
  * - Custom maps for F13-F24 are set for keys Q-P
+ * - With KEY_TRACE_ENABLE, Esc dumps the key event trace to the console
  *
  * ┌───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───────┬───┐
  * │   │F1 │F2 │F3 │F4 │F5 │F6 │F7 │F8 │F9 │F10│F11│F12│       │   │
@@ -163,44 +273,19 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
  * KPI - Keyboard RGB speed increase
  * KPD - Keyboard RGB speed decrease
  */
-[_MAC_FN2] = LAYOUT_65_ansi(
-  // 0,    1,      2,      3,      4,      5,      6,      7,      8,      9,      10,     11,     12,     13,    14,      15
-  KC_NO, KC_F1,  KC_F2,  KC_F3,  KC_F4,  KC_F5,  KC_F6,  KC_F7,  KC_F8,  KC_F9,  KC_F10, KC_F11, KC_F12, KC_NO,          KC_NO,
-  KC_NO, KC_F13, KC_F14, KC_F15, KC_F16, KC_F17, KC_F18, KC_F19, KC_F20, KC_F21, KC_F22, KC_F23, KC_F24, KC_NO,          KC_NO,
-  KC_NO, KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,          KC_NO,          KC_NO,
-  KC_NO,         KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,          KC_NO, RGB_SPI, KC_NO,
-  KC_NO, KC_NO,  KC_NO,                          KC_NO,                          KC_NO,  KC_NO,  KC_NO,  KC_NO, RGB_SPD, KC_NO
-),
-
-/**
- * Windows Main Layer
- *
- * ┌───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───┬───────┬───┐
- * │ ` │ 1 │ 2 │ 3 │ 4 │ 5 │ 6 │ 7 │ 8 │ 9 │ 0 │ - │ + │ BKSPC │KLC│
- * ├───┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─────┼───┤
- * │ TAB │ Q │ W │ E │ R │ T │ Y │ U │ I │ O │ P │ [ │ ] │  \  │HOM│
- * ├─────┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴┬──┴─────┼───┤    
- * │ ESC  │ A │ S │ D │ F │ G │ H │ J │ K │ L │ ; │ ' │ ENTER  │PUP│
- * ├──────┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴─┬─┴────┬───┼───┤
- * │ LSHIFT │ Z │ X │ C │ V │ B │ N │ M │ , │ . │ - │RSHIFT│UP │PDN│
- * ├────┬───┴┬──┴─┬─┴───┴───┴───┴───┴───┴──┬┴──┬┴──┬┴──┬───┼───┼───┤
- * │CTRL│WIN │ALT │                        │CTL│FN1│FN2│LFT│DWN│RGT│
- * └────┴────┴────┴────────────────────────┴───┴───┴───┴───┴───┴───┘
- *
- * KLC - Keyboard RGB mode cycle
- * HOM - Home
- * PUP - Page Up
- * PDN - Page Down
- */
-[_WIN_BASE] = LAYOUT_65_ansi(
-  // 0,    1,       2,       3,    4,    5,    6,      7,    8,    9,       10,       11,           12,           13,        14,      15
-  KC_ESC,  KC_1,    KC_2,    KC_3, KC_4, KC_5, KC_6,   KC_7, KC_8, KC_9,    KC_0,     KC_MINS,      KC_EQL,       KC_BSPC,            RGB_MOD,
-  KC_TAB,  KC_Q,    KC_W,    KC_E, KC_R, KC_T, KC_Y,   KC_U, KC_I, KC_O,    KC_P,     KC_LBRC,      KC_RBRC,      KC_BSLASH,          KC_HOME,
-  KC_ESC,  KC_A,    KC_S,    KC_D, KC_F, KC_G, KC_H,   KC_J, KC_K, KC_L,    KC_SCLN,  KC_QUOT,                    KC_ENT,             KC_PGUP,
-  KC_LSFT,          KC_Z,    KC_X, KC_C, KC_V, KC_B,   KC_N, KC_M, KC_COMM, KC_DOT,   KC_SLSH,                    KC_RSFT,   KC_UP,   KC_PGDOWN,
-  KC_LCTL, KC_LGUI, KC_LALT,                   KC_SPC,                      KC_RCTRL, MO(_WIN_FN1), MO(_WIN_FN2), KC_LEFT,   KC_DOWN, KC_RGHT
-),
+static const sparse_key_t PROGMEM fn2_keys[] = {
+#ifdef KEY_TRACE_ENABLE
+  {POS_ESC,  KEY_TRACE_DUMP},
+#endif
+  {POS_1,    KC_F1},   {POS_2,    KC_F2},   {POS_3,    KC_F3},   {POS_4,    KC_F4},   {POS_5,    KC_F5},   {POS_6,    KC_F6},
+  {POS_7,    KC_F7},   {POS_8,    KC_F8},   {POS_9,    KC_F9},   {POS_0,    KC_F10},  {POS_MINS, KC_F11},  {POS_EQL,  KC_F12},
+  {POS_Q,    KC_F13},  {POS_W,    KC_F14},  {POS_E,    KC_F15},  {POS_R,    KC_F16},  {POS_T,    KC_F17},  {POS_Y,    KC_F18},
+  {POS_U,    KC_F19},  {POS_I,    KC_F20},  {POS_O,    KC_F21},  {POS_P,    KC_F22},  {POS_LBRC, KC_F23},  {POS_RBRC, KC_F24},
+  {POS_UP,   RGB_SPI},
+  {POS_DOWN, RGB_SPD}
+};
 
+#ifdef K6_WIN_LAYERS
 /**
  * Windows FN1 Layer
  *
@@ -230,14 +315,17 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
  * KLB - Keyboard RGB light style back
  * KLF - Keyboard RGB light style forward
  */
-[_WIN_FN1] = LAYOUT_65_ansi(
-  // 0,    1,       2,       3,     4,     5,       6,       7,       8,       9,       10,      11,      12,      13,      14,      15
-  KC_GRV,  KC_BRID, KC_BRIU, KC_NO, KC_NO, RGB_VAD, RGB_VAI, KC_MPRV, KC_MPLY, KC_MNXT, KC_MUTE, KC_VOLD, KC_VOLU, KC_NO,            RGB_TOG,
-  KC_NO,   KC_NO,   KC_NO,   KC_NO, KC_NO, KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_INS,  KC_DEL,  KC_END,  KC_NO,            KC_NO,
-  KC_CAPS, KC_NO,   KC_NO,   KC_NO, KC_NO, KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,            KC_NO,            KC_NO,
-  KC_TRNS,          KC_NO,   KC_NO, KC_NO, KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,   KC_NO,            KC_TRNS, RGB_SAI, KC_NO,
-  KC_TRNS, KC_TRNS, KC_TRNS,                        RESET,                              KC_TRNS, KC_NO,   KC_NO,   RGB_HUD, RGB_SAD, RGB_HUI
-),
+static const sparse_key_t PROGMEM win_fn1_keys[] = {
+  {POS_ESC,  KC_GRV},  {POS_1,    KC_BRID}, {POS_2,    KC_BRIU},
+  {POS_5,    RGB_VAD}, {POS_6,    RGB_VAI}, {POS_7,    KC_MPRV}, {POS_8,    KC_MPLY}, {POS_9,    KC_MNXT},
+  {POS_0,    KC_MUTE}, {POS_MINS, KC_VOLD}, {POS_EQL,  KC_VOLU}, {POS_LIGHT, RGB_TOG},
+  {POS_P,    KC_INS},  {POS_LBRC, KC_DEL},  {POS_RBRC, KC_END},
+  {POS_CAPS, KC_CAPS},
+  {POS_LSFT, KC_TRNS}, {POS_RSFT, KC_TRNS}, {POS_UP,   RGB_SAI},
+  {POS_LCTL, KC_TRNS}, {POS_LALT, KC_TRNS}, {POS_LGUI, KC_TRNS}, {POS_SPC,  RESET},   {POS_RGUI, KC_TRNS},
+  {POS_LEFT, RGB_HUD}, {POS_DOWN, RGB_SAD}, {POS_RGHT, RGB_HUI}
+};
+#endif
 
 /**
  * Windows FN2 Layer
@@ -256,18 +344,62 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
  *
  * KPI - Keyboard RGB speed increase
  * KPD - Keyboard RGB speed decrease
+ *
+ * Identical to the macOS FN2 layer, so both share fn2_keys.
  */
-[_WIN_FN2] = LAYOUT_65_ansi(
-  // 0,  1,      2,      3,      4,      5,      6,      7,      8,      9,      10,     11,     12,     13,    14,      15
-  KC_NO, KC_F1,  KC_F2,  KC_F3,  KC_F4,  KC_F5,  KC_F6,  KC_F7,  KC_F8,  KC_F9,  KC_F10, KC_F11, KC_F12, KC_NO,          KC_NO,
-  KC_NO, KC_F13, KC_F14, KC_F15, KC_F16, KC_F17, KC_F18, KC_F19, KC_F20, KC_F21, KC_F22, KC_F23, KC_F24, KC_NO,          KC_NO,
-  KC_NO, KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,          KC_NO,          KC_NO,
-  KC_NO,         KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,          KC_NO, RGB_SPI, KC_NO,
-  KC_NO, KC_NO,  KC_NO,                          KC_NO,                          KC_NO,  KC_NO,  KC_NO,  KC_NO, RGB_SPD, KC_NO
-)
 
+// Each FN layer's overlay, and the base layer its KC_TRNS keys fall through to.
+typedef struct {
+  sparse_layer_t overlay;
+  uint8_t        base;
+} fn_layer_t;
+
+static const fn_layer_t fn_layers[] = {
+#ifdef K6_MAC_LAYERS
+  [_MAC_FN1 - FN_LAYERS_START] = {SPARSE_LAYER(mac_fn1_keys), _MAC_BASE},
+  [_MAC_FN2 - FN_LAYERS_START] = {SPARSE_LAYER(fn2_keys),     _MAC_BASE},
+#endif
+#ifdef K6_WIN_LAYERS
+  [_WIN_FN1 - FN_LAYERS_START] = {SPARSE_LAYER(win_fn1_keys), _WIN_BASE},
+  [_WIN_FN2 - FN_LAYERS_START] = {SPARSE_LAYER(fn2_keys),     _WIN_BASE},
+#endif
 };
+#endif
+
+#ifdef RGB_MATRIX_ENABLE
+// Colors for the FN layer indicator, kept dim since it is on whenever an FN
+// key is held.
+static const uint8_t fn_layer_colors[][3] = {
+#ifdef K6_MAC_LAYERS
+  [_MAC_FN1 - FN_LAYERS_START] = {0x60, 0x60, 0x60}, // white
+  [_MAC_FN2 - FN_LAYERS_START] = {0x00, 0x60, 0x60}, // cyan
+#endif
+#ifdef K6_WIN_LAYERS
+  [_WIN_FN1 - FN_LAYERS_START] = {0x00, 0x20, 0x60}, // blue
+  [_WIN_FN2 - FN_LAYERS_START] = {0x40, 0x00, 0x60}, // purple
+#endif
+};
+
+// While an FN layer is held, light the keys that do something on it.
+static void update_layer_leds(uint8_t layer) {
+  if (layer < FN_LAYERS_START) {
+    layer_leds_hide();
+    return;
+  }
 
+  const uint8_t *color = fn_layer_colors[layer - FN_LAYERS_START];
+  layer_leds_show(layer, color[0], color[1], color[2]);
+}
+#endif
+
+layer_state_t layer_state_set_user(layer_state_t state) {
+#ifdef RGB_MATRIX_ENABLE
+  update_layer_leds(get_highest_layer(state | default_layer_state));
+#endif
+  return state;
+}
+
+#if defined(K6_MAC_LAYERS) && defined(K6_WIN_LAYERS)
 bool dip_switch_update_user(uint8_t index, bool active){
   switch (index) {
     case 0: // macOS/windows toggle
@@ -280,12 +412,18 @@ bool dip_switch_update_user(uint8_t index, bool active){
   }
   return true;
 }
+#endif
 
 // Disable RGB at boot
 void matrix_init_user(void) {
   rgblight_disable_noeeprom();
 }
 
+// Save any pending RGB changes before the host powers the keyboard down
+void suspend_power_down_user(void) {
+  rgb_cache_flush();
+}
+
 void keyboard_post_init_user(void) {
   // Customise these values to desired behaviour
   //debug_enable=true;
@@ -294,51 +432,138 @@ void keyboard_post_init_user(void) {
   //debug_mouse=true;
 }
 
-uint8_t mod_state;
+// Keys whose output depends on the modifiers held, custom keycodes or plain
+// ones. The first matching row for a keycode wins, so put the most specific
+// rows first. A build with no rows (K6_OS = windows) has an empty table.
+const mod_override_t mod_overrides[] = {
+#ifdef K6_MAC_LAYERS
+  // FN1 + CMD + 3:  Show Desktop (via F11)
+  // FN1 + CTRL + 3: Exposé current apps' windows (via Ctrl-Down)
+  // FN1 + 3:        Exposé all apps' windows (via Ctrl-Up)
+  //
+  // trigger,   required,      suppressed,            output,  output mods
+  {MAC_EXPOSE, MOD_MASK_GUI,  MOD_OVERRIDE_ALL_MODS, KC_F11,  0},
+  {MAC_EXPOSE, MOD_MASK_CTRL, MOD_OVERRIDE_ALL_MODS, KC_DOWN, MOD_MASK_CTRL},
+  {MAC_EXPOSE, 0,             MOD_OVERRIDE_ALL_MODS, KC_UP,   MOD_MASK_CTRL},
+#endif
+};
+
+const uint8_t mod_override_count = sizeof(mod_overrides) / sizeof(mod_overrides[0]);
+
+_Static_assert(sizeof(mod_overrides) / sizeof(mod_overrides[0]) <= 32, "mod_overrides is limited to 32 rows");
+
+static bool process_record_keymap(uint16_t keycode, keyrecord_t *record) {
+#ifdef KEY_TRACE_ENABLE
+  key_trace_record(record);
+#endif
+
+  scan_governor_activity(timer_read32());
+
+  if (keycode == ESC_CTRL) {
+    if (record->event.pressed) {
+      esc_ctrl_press();
+    } else {
+      esc_ctrl_release();
+    }
+    return false;
+  }
+
+  if (record->event.pressed) {
+    esc_ctrl_interrupt();
+  }
+
+  if (!process_rgb_cache(keycode, record)) {
+    return false;
+  }
+
+  // Override triggers can be plain QMK keycodes too, so check the table
+  // before handing those back.
+  if (!process_mod_override(keycode, record)) {
+    return false;
+  }
+
+  // Nearly every event is a plain QMK keycode; hand those straight back to
+  // the core.
+  if (keycode < SAFE_RANGE) {
+    return true;
+  }
+
+#ifdef KEY_TRACE_ENABLE
+  if (keycode == KEY_TRACE_DUMP) {
+    if (record->event.pressed) {
+      key_trace_dump();
+    }
+    return false;
+  }
+#endif
+
+  return true;
+}
+
+// Once the keyboard has been idle for a while, sleep between scans. The main
+// loop doesn't run while waiting, so the matrix is scanned at the idle rate.
+// RGB effects animate from the main loop, so stay at full rate while they
+// are on.
+//
+// The first key event after an idle period only comes out of debounce, so
+// stay awake from the first scan that sees the matrix change. Sleeping
+// through the debounce would add another idle interval to that keystroke.
+static void scan_governor_sleep(void) {
+#ifdef RGB_MATRIX_ENABLE
+  if (rgb_matrix_is_enabled()) {
+    return;
+  }
+#endif
+
+  if (debounce_active()) {
+    return;
+  }
+
+  uint16_t delay = scan_governor_delay(timer_read32());
+
+  if (delay) {
+    wait_ms(delay);
+  }
+}
+
+void housekeeping_task_user(void) {
+  esc_ctrl_task();
+  rgb_cache_task();
+#ifdef RGB_MATRIX_ENABLE
+  layer_leds_render();
+#endif
+  scan_governor_sleep();
+#ifdef LATENCY_STATS_ENABLE
+  latency_stats_task();
+#endif
+}
+
+#ifdef LATENCY_STATS_ENABLE
+void matrix_scan_user(void) {
+  latency_stats_mark(LATENCY_SCAN);
+}
 
 bool process_record_user(uint16_t keycode, keyrecord_t *record) {
-  mod_state = get_mods();
-
-  switch (keycode) {
-    // FN1 + 3:        Exposé all apps' windows (via Ctrl-Up)
-    // FN1 + CTRL + 3: Exposé current apps' windows (via Ctrl-Down)
-    // FN1 + CMD + 3:  Show Desktop (via F11)
-    case MAC_EXPOSE:
-      if (mod_state & MOD_MASK_GUI) {
-        if (record->event.pressed) {
-          clear_mods();
-          register_code(KC_F11);
-          set_mods(mod_state);
-        } else {
-          unregister_code(KC_F11);
-          set_mods(mod_state);
-        }
-      } else if (mod_state & MOD_MASK_CTRL) {
-        if (record->event.pressed) {
-          clear_mods();
-          set_mods(MOD_MASK_CTRL);
-          register_code(KC_DOWN);
-          set_mods(mod_state);
-        } else {
-          unregister_code(KC_DOWN);
-          set_mods(mod_state);
-        }
-      } else {
-        if (record->event.pressed) {
-          clear_mods();
-          set_mods(MOD_MASK_CTRL);
-          register_code(KC_UP);
-          set_mods(mod_state);
-        } else {
-          unregister_code(KC_UP);
-          set_mods(mod_state);
-        }
-      }
+  latency_stats_mark(LATENCY_DISPATCH);
+  bool result = process_record_keymap(keycode, record);
+  latency_stats_mark(LATENCY_USER);
 
-      return false;
-      break;
-    default:
-      return true;
-      break;
+  // QMK skips post_process_record_user for any event a processor stopped,
+  // this keymap or one of QMK's own. Finish the ones stopped here;
+  // latency_stats.c drops what it can't time of the others.
+  if (!result) {
+    latency_stats_event_done();
   }
+
+  return result;
+}
+
+void post_process_record_user(uint16_t keycode, keyrecord_t *record) {
+  latency_stats_mark(LATENCY_REPORT);
+  latency_stats_event_done();
+}
+#else
+bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+  return process_record_keymap(keycode, record);
 }
+#endif
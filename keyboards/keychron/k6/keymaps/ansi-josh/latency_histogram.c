@@ -0,0 +1,85 @@
+#include <string.h>
+#include "latency_histogram.h"
+
+// Nothing in here touches the hardware, so it builds as-is on the host.
+
+static uint8_t bucket_for(uint32_t value) {
+  if (value < 2) {
+    return value;
+  }
+
+  uint8_t exponent = 31 - __builtin_clz(value);
+  uint8_t bucket   = exponent * 2 + ((value >> (exponent - 1)) & 1);
+
+  return bucket < LATENCY_HISTOGRAM_BUCKETS ? bucket : LATENCY_HISTOGRAM_BUCKETS - 1;
+}
+
+// Largest value that lands in the given bucket.
+uint32_t latency_histogram_bucket_max(uint8_t bucket) {
+  if (bucket < 2) {
+    return bucket;
+  }
+
+  uint8_t  exponent = bucket / 2;
+  uint32_t half     = (uint32_t)1 << (exponent - 1);
+
+  return ((uint32_t)1 << exponent) + (bucket & 1) * half + half - 1;
+}
+
+void latency_histogram_reset(latency_histogram_t *histogram) {
+  memset(histogram, 0, sizeof(*histogram));
+  histogram->min = UINT32_MAX;
+}
+
+void latency_histogram_add(latency_histogram_t *histogram, uint32_t value) {
+  uint8_t bucket = bucket_for(value);
+
+  if (histogram->buckets[bucket] < UINT16_MAX) {
+    histogram->buckets[bucket]++;
+  }
+  if (value < histogram->min) {
+    histogram->min = value;
+  }
+  if (value > histogram->max) {
+    histogram->max = value;
+  }
+  histogram->sum += value;
+  histogram->count++;
+}
+
+uint32_t latency_histogram_average(const latency_histogram_t *histogram) {
+  if (histogram->count == 0) {
+    return 0;
+  }
+
+  return histogram->sum / histogram->count;
+}
+
+// Upper bound of the bucket holding the given percentile, clamped to the
+// largest value actually seen (which is also the answer when it falls in the
+// open-ended last bucket). Walks the buckets rather than trusting count,
+// since a bucket can saturate.
+uint32_t latency_histogram_percentile(const latency_histogram_t *histogram, uint8_t percent) {
+  uint32_t total = 0;
+
+  for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    total += histogram->buckets[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  uint32_t target = ((uint64_t)total * percent + 99) / 100;
+  uint32_t seen   = 0;
+
+  for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    seen += histogram->buckets[i];
+
+    if (seen >= target && i < LATENCY_HISTOGRAM_BUCKETS - 1) {
+      uint32_t bound = latency_histogram_bucket_max(i);
+      return bound < histogram->max ? bound : histogram->max;
+    }
+  }
+
+  return histogram->max;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+// Two buckets per power of two: bucket i covers [2^e, 2^e + 2^(e-1)) when
+// i = 2e and the upper half of that octave when i = 2e + 1. 48 buckets cover
+// values up to 2^24 cycles (~350ms at 48MHz); anything above lands in the
+// last bucket.
+#define LATENCY_HISTOGRAM_BUCKETS 48
+
+typedef struct {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+  uint16_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+} latency_histogram_t;
+
+void     latency_histogram_reset(latency_histogram_t *histogram);
+void     latency_histogram_add(latency_histogram_t *histogram, uint32_t value);
+uint32_t latency_histogram_average(const latency_histogram_t *histogram);
+uint32_t latency_histogram_percentile(const latency_histogram_t *histogram, uint8_t percent);
+uint32_t latency_histogram_bucket_max(uint8_t bucket);
@@ -0,0 +1,118 @@
+#include QMK_KEYBOARD_H
+#include "cycle_clock.h"
+#include "latency_histogram.h"
+#include "latency_stats.h"
+
+static latency_histogram_t histograms[LATENCY_STAGE_COUNT];
+static uint32_t            loop_start;
+static uint32_t            last_mark;
+static uint32_t            scan_cycles;
+static bool                scan_pending;
+static bool                event_open;
+static uint16_t            last_summary;
+static bool                initialized;
+
+static void put_u32(uint8_t *buffer, uint32_t value) {
+  buffer[0] = value;
+  buffer[1] = value >> 8;
+  buffer[2] = value >> 16;
+  buffer[3] = value >> 24;
+}
+
+// Summary packet, sent as one hex-encoded console line prefixed with "LAT ":
+//
+//   u8  version (1)
+//   u8  stage count
+//   u32 cycles per second
+//   per stage: u32 count, u32 min, u32 avg, u32 p99, u32 max (cycles)
+//
+// All integers are little-endian. Decode with scripts/latency-stats.py.
+#define SUMMARY_HEADER_SIZE 6
+#define SUMMARY_STAGE_SIZE  20
+#define SUMMARY_SIZE        (SUMMARY_HEADER_SIZE + LATENCY_STAGE_COUNT * SUMMARY_STAGE_SIZE)
+
+static void send_summary(void) {
+  static const char hex[] = "0123456789ABCDEF";
+  uint8_t           packet[SUMMARY_SIZE];
+  char              line[SUMMARY_SIZE * 2 + 1];
+
+  packet[0] = 1;
+  packet[1] = LATENCY_STAGE_COUNT;
+  put_u32(&packet[2], cycle_clock_frequency());
+
+  for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    latency_histogram_t *histogram = &histograms[stage];
+    uint8_t             *out       = &packet[SUMMARY_HEADER_SIZE + stage * SUMMARY_STAGE_SIZE];
+
+    put_u32(&out[0], histogram->count);
+    put_u32(&out[4], histogram->count ? histogram->min : 0);
+    put_u32(&out[8], latency_histogram_average(histogram));
+    put_u32(&out[12], latency_histogram_percentile(histogram, 99));
+    put_u32(&out[16], histogram->max);
+
+    latency_histogram_reset(histogram);
+  }
+
+  for (uint8_t i = 0; i < SUMMARY_SIZE; i++) {
+    line[i * 2]     = hex[packet[i] >> 4];
+    line[i * 2 + 1] = hex[packet[i] & 0xF];
+  }
+  line[SUMMARY_SIZE * 2] = '\0';
+
+  uprintf("LAT %s\n", line);
+}
+
+// Called once per main loop. Sends the summary when it is due, outside of
+// any measured stage, then marks the start of the next loop.
+void latency_stats_task(void) {
+  if (!initialized) {
+    for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+      latency_histogram_reset(&histograms[stage]);
+    }
+    last_summary = timer_read();
+    initialized  = true;
+  } else if (timer_elapsed(last_summary) >= LATENCY_STATS_INTERVAL) {
+    send_summary();
+    last_summary = timer_read();
+  }
+
+  // The loop ended without the scan leading to an event, or with an event
+  // one of QMK's own processors stopped before post_process_record_user.
+  scan_pending = false;
+  event_open   = false;
+
+  loop_start = last_mark = cycle_clock_now();
+}
+
+void latency_stats_mark(latency_stage_t stage) {
+  uint32_t now = cycle_clock_now();
+
+  if (stage == LATENCY_SCAN) {
+    // Nearly every scan finds nothing, so hold on to its time until it turns
+    // out to have produced an event.
+    scan_cycles  = now - last_mark;
+    scan_pending = true;
+  } else if (stage == LATENCY_DISPATCH && event_open) {
+    // The previous event in this scan never finished, so the time since its
+    // last mark includes QMK handling it. Skip this dispatch sample.
+    scan_pending = false;
+  } else if (initialized) {
+    if (stage == LATENCY_DISPATCH && scan_pending) {
+      latency_histogram_add(&histograms[LATENCY_SCAN], scan_cycles);
+      scan_pending = false;
+    }
+    latency_histogram_add(&histograms[stage], now - last_mark);
+  }
+
+  if (stage == LATENCY_DISPATCH) {
+    event_open = true;
+  }
+  last_mark = now;
+}
+
+void latency_stats_event_done(void) {
+  if (initialized) {
+    latency_histogram_add(&histograms[LATENCY_TOTAL], last_mark - loop_start);
+  }
+  event_open = false;
+}
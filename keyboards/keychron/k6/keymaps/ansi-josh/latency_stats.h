@@ -0,0 +1,24 @@
+#pragma once
+
+#include "quantum.h"
+
+// Stages of a key event, each timed from the end of the one before it. Only
+// scans that lead to an event count towards LATENCY_SCAN, and events that
+// never reach post_process_record_user only towards the stages they passed.
+typedef enum {
+  LATENCY_SCAN,     // loop start => matrix_scan_user (matrix read + debounce)
+  LATENCY_DISPATCH, // => process_record_user (QMK action and layer lookup)
+  LATENCY_USER,     // => process_record_user returns (this keymap)
+  LATENCY_REPORT,   // => post_process_record_user (QMK keycode + HID send)
+  LATENCY_TOTAL,    // matrix scan start => event fully handled
+  LATENCY_STAGE_COUNT
+} latency_stage_t;
+
+// Send a summary over the console every this many ms.
+#ifndef LATENCY_STATS_INTERVAL
+#  define LATENCY_STATS_INTERVAL 5000
+#endif
+
+void latency_stats_task(void);
+void latency_stats_mark(latency_stage_t stage);
+void latency_stats_event_done(void);
@@ -0,0 +1,113 @@
+#include QMK_KEYBOARD_H
+#include "cycle_clock.h"
+#include "layer_leds.h"
+
+// Lights up the keys that do something on the active FN layer while the RGB
+// effects are off. The wanted state is only worked out on the first render
+// after a layer change; rendering then writes just the LEDs that differ from
+// what the driver already shows, as many as fit in the frame budget.
+
+#define LED_BYTES ((DRIVER_LED_TOTAL + 7) / 8)
+#define NO_LAYER  UINT8_MAX
+
+static uint8_t  target_lit[LED_BYTES];
+static uint8_t  shown_lit[LED_BYTES];
+static uint8_t  dirty[LED_BYTES];
+static uint8_t  color[3];
+static bool     any_dirty;
+static bool     effects_were_on;
+static uint16_t settle_start;
+static uint8_t  next_layer = NO_LAYER;
+static uint8_t  next_color[3];
+static bool     layer_changed;
+
+static void update_target(void) {
+  bool color_changed = memcmp(color, next_color, sizeof(color)) != 0;
+
+  memset(target_lit, 0, sizeof(target_lit));
+
+  if (next_layer != NO_LAYER) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+      for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        uint8_t  led = g_led_config.matrix_co[row][col];
+        keypos_t key = { .col = col, .row = row };
+
+        if (led != NO_LED && keymap_key_to_keycode(next_layer, key) != KC_NO) {
+          target_lit[led / 8] |= 1 << (led % 8);
+        }
+      }
+    }
+  }
+
+  memcpy(color, next_color, sizeof(color));
+  layer_changed = false;
+
+  for (uint8_t i = 0; i < LED_BYTES; i++) {
+    dirty[i] |= (target_lit[i] ^ shown_lit[i]) | (color_changed ? target_lit[i] : 0);
+    if (dirty[i]) {
+      any_dirty = true;
+    }
+  }
+}
+
+void layer_leds_show(uint8_t layer, uint8_t red, uint8_t green, uint8_t blue) {
+  next_layer    = layer;
+  next_color[0] = red;
+  next_color[1] = green;
+  next_color[2] = blue;
+  layer_changed = true;
+}
+
+void layer_leds_hide(void) {
+  next_layer    = NO_LAYER;
+  layer_changed = true;
+}
+
+void layer_leds_render(void) {
+  // The effects paint every LED themselves, so whatever was drawn is gone.
+  if (rgb_matrix_is_enabled()) {
+    effects_were_on = true;
+    return;
+  }
+
+  uint32_t start = cycle_clock_now();
+
+  if (layer_changed) {
+    update_target();
+  }
+  if (effects_were_on) {
+    effects_were_on = false;
+    settle_start    = timer_read();
+    memset(shown_lit, 0, sizeof(shown_lit));
+    memcpy(dirty, target_lit, sizeof(dirty));
+    any_dirty = true;
+  }
+  if (!any_dirty || timer_elapsed(settle_start) < LAYER_LEDS_SETTLE_TIME) {
+    return;
+  }
+
+  uint32_t budget = cycle_clock_frequency() / 1000000 * LAYER_LEDS_FRAME_BUDGET_US;
+
+  for (uint8_t i = 0; i < LED_BYTES; i++) {
+    while (dirty[i]) {
+      uint8_t bit  = __builtin_ctz(dirty[i]);
+      uint8_t led  = i * 8 + bit;
+      uint8_t mask = 1 << bit;
+
+      if (target_lit[i] & mask) {
+        rgb_matrix_set_color(led, color[0], color[1], color[2]);
+        shown_lit[i] |= mask;
+      } else {
+        rgb_matrix_set_color(led, 0, 0, 0);
+        shown_lit[i] &= ~mask;
+      }
+      dirty[i] &= ~mask;
+
+      if (cycle_clock_now() - start >= budget) {
+        return;
+      }
+    }
+  }
+
+  any_dirty = false;
+}
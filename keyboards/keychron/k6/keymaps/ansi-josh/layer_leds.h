@@ -0,0 +1,24 @@
+#pragma once
+
+#include "quantum.h"
+
+// How long one call to layer_leds_render() may spend, in µs, counting the
+// keymap walk after a layer change. It writes at least one LED per call and
+// leaves the rest for the next, so a layer change never stalls a scan for
+// much longer than this. test/bench_layer_leds shows what each change costs.
+#ifndef LAYER_LEDS_FRAME_BUDGET_US
+#  define LAYER_LEDS_FRAME_BUDGET_US 50
+#endif
+
+// After the RGB effects are switched off, RGB matrix blanks every LED once.
+// Wait this long before drawing so that doesn't wipe out the indicator.
+#ifndef LAYER_LEDS_SETTLE_TIME
+#  define LAYER_LEDS_SETTLE_TIME 50
+#endif
+
+// Lights every key of layer that keymap_key_to_keycode() doesn't give as
+// KC_NO, in one color. The keys are looked up by the next layer_leds_render()
+// rather than here, so this is cheap enough to call from a key event.
+void layer_leds_show(uint8_t layer, uint8_t red, uint8_t green, uint8_t blue);
+void layer_leds_hide(void);
+void layer_leds_render(void);
@@ -0,0 +1,67 @@
+#include QMK_KEYBOARD_H
+#include "mod_override.h"
+#include "report_batch.h"
+
+// One bit per table row that is currently held down. Releases look here
+// rather than at the modifiers, which may have changed since the press.
+static uint32_t active_rows;
+
+static bool mod_override_press(uint16_t keycode) {
+  uint8_t mods = get_mods();
+
+  for (uint8_t i = 0; i < mod_override_count; i++) {
+    const mod_override_t *row = &mod_overrides[i];
+
+    if (row->trigger != keycode) {
+      continue;
+    }
+    if (row->required_mods && !(mods & row->required_mods)) {
+      continue;
+    }
+
+    if (IS_KEY(row->keycode)) {
+      report_batch_set_mods((mods & ~row->suppressed_mods) | row->mods);
+      report_batch_add_key(row->keycode);
+      report_batch_flush();
+    } else {
+      register_code16(row->keycode);
+    }
+    active_rows |= (uint32_t)1 << i;
+    return false;
+  }
+
+  return true;
+}
+
+static bool mod_override_release(uint16_t keycode) {
+  // Nearly every release, since overridden keys are rarely held.
+  if (!active_rows) {
+    return true;
+  }
+
+  for (uint8_t i = 0; i < mod_override_count; i++) {
+    if (!(active_rows & ((uint32_t)1 << i)) || mod_overrides[i].trigger != keycode) {
+      continue;
+    }
+
+    if (IS_KEY(mod_overrides[i].keycode)) {
+      report_batch_del_key(mod_overrides[i].keycode);
+      report_batch_flush();
+    } else {
+      unregister_code16(mod_overrides[i].keycode);
+    }
+    active_rows &= ~((uint32_t)1 << i);
+    return false;
+  }
+
+  return true;
+}
+
+// Returns false when the event was consumed by an override row.
+bool process_mod_override(uint16_t keycode, keyrecord_t *record) {
+  if (record->event.pressed) {
+    return mod_override_press(keycode);
+  }
+
+  return mod_override_release(keycode);
+}
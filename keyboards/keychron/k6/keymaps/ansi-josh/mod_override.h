@@ -0,0 +1,25 @@
+#pragma once
+
+#include "quantum.h"
+
+#define MOD_OVERRIDE_ALL_MODS 0xFF
+
+// One row of the modifier override table. A press of `trigger`, which can be
+// any keycode, matches the first row whose `required_mods` has at least one
+// modifier held (0 always matches). A keyboard `keycode` is sent in one
+// report with the held modifiers minus `suppressed_mods`, plus `mods`.
+// Consumer and system keycodes (KC_MUTE, KC_PWR etc.) have no modifiers, so
+// they are sent with register_code16() and the modifier fields are ignored.
+typedef struct {
+  uint16_t trigger;
+  uint8_t  required_mods;
+  uint8_t  suppressed_mods;
+  uint16_t keycode;
+  uint8_t  mods;
+} mod_override_t;
+
+// Defined by the keymap, at most 32 rows.
+extern const mod_override_t mod_overrides[];
+extern const uint8_t        mod_override_count;
+
+bool process_mod_override(uint16_t keycode, keyrecord_t *record);
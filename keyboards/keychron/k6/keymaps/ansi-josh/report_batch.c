@@ -0,0 +1,47 @@
+#include QMK_KEYBOARD_H
+#include "report_batch.h"
+
+static bool    report_dirty;
+static bool    override_pending;
+static uint8_t override_mods;
+
+void report_batch_add_key(uint8_t keycode) {
+  add_key(keycode);
+  report_dirty = true;
+}
+
+void report_batch_del_key(uint8_t keycode) {
+  del_key(keycode);
+  report_dirty = true;
+}
+
+// The next flushed report carries exactly these modifiers, whatever is
+// physically held. The real modifier state is left alone, so later reports
+// go back to reflecting it.
+void report_batch_set_mods(uint8_t mods) {
+  override_mods    = mods;
+  override_pending = true;
+  report_dirty     = true;
+}
+
+void report_batch_flush(void) {
+  if (!report_dirty) {
+    return;
+  }
+
+  if (override_pending) {
+    uint8_t mods      = get_mods();
+    uint8_t weak_mods = get_weak_mods();
+
+    set_mods(override_mods);
+    clear_weak_mods();
+    send_keyboard_report();
+    set_weak_mods(weak_mods);
+    set_mods(mods);
+  } else {
+    send_keyboard_report();
+  }
+
+  report_dirty     = false;
+  override_pending = false;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "quantum.h"
+
+// Custom keycodes stage their key and modifier changes here, then send them
+// to the host as a single report with report_batch_flush(). The host never
+// sees the intermediate states in between.
+void report_batch_add_key(uint8_t keycode);
+void report_batch_del_key(uint8_t keycode);
+void report_batch_set_mods(uint8_t mods);
+void report_batch_flush(void);
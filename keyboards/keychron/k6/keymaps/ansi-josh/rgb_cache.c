@@ -0,0 +1,111 @@
+#include QMK_KEYBOARD_H
+#include "rgb_cache.h"
+
+// The K6 drives its LEDs with RGB matrix. Fall back to rgblight names so the
+// keymap still builds on a board using that instead.
+#ifdef RGB_MATRIX_ENABLE
+#  define rgb_toggle_noeeprom         rgb_matrix_toggle_noeeprom
+#  define rgb_step_noeeprom           rgb_matrix_step_noeeprom
+#  define rgb_step_reverse_noeeprom   rgb_matrix_step_reverse_noeeprom
+#  define rgb_increase_hue_noeeprom   rgb_matrix_increase_hue_noeeprom
+#  define rgb_decrease_hue_noeeprom   rgb_matrix_decrease_hue_noeeprom
+#  define rgb_increase_sat_noeeprom   rgb_matrix_increase_sat_noeeprom
+#  define rgb_decrease_sat_noeeprom   rgb_matrix_decrease_sat_noeeprom
+#  define rgb_increase_val_noeeprom   rgb_matrix_increase_val_noeeprom
+#  define rgb_decrease_val_noeeprom   rgb_matrix_decrease_val_noeeprom
+#  define rgb_increase_speed_noeeprom rgb_matrix_increase_speed_noeeprom
+#  define rgb_decrease_speed_noeeprom rgb_matrix_decrease_speed_noeeprom
+#  define rgb_config_write            eeconfig_update_rgb_matrix
+#else
+#  define rgb_toggle_noeeprom         rgblight_toggle_noeeprom
+#  define rgb_step_noeeprom           rgblight_step_noeeprom
+#  define rgb_step_reverse_noeeprom   rgblight_step_reverse_noeeprom
+#  define rgb_increase_hue_noeeprom   rgblight_increase_hue_noeeprom
+#  define rgb_decrease_hue_noeeprom   rgblight_decrease_hue_noeeprom
+#  define rgb_increase_sat_noeeprom   rgblight_increase_sat_noeeprom
+#  define rgb_decrease_sat_noeeprom   rgblight_decrease_sat_noeeprom
+#  define rgb_increase_val_noeeprom   rgblight_increase_val_noeeprom
+#  define rgb_decrease_val_noeeprom   rgblight_decrease_val_noeeprom
+#  define rgb_increase_speed_noeeprom rgblight_increase_speed_noeeprom
+#  define rgb_decrease_speed_noeeprom rgblight_decrease_speed_noeeprom
+#  define rgb_config_write            eeconfig_update_rgblight_current
+#endif
+
+static bool     config_dirty;
+static uint16_t last_change;
+
+// Handles the RGB keycodes in place of QMK's process_rgb, applying each
+// change in RAM only. Shift reverses the direction, as it does in QMK.
+bool process_rgb_cache(uint16_t keycode, keyrecord_t *record) {
+  if (keycode < RGB_TOG || keycode > RGB_SPD) {
+    return true;
+  }
+  if (!record->event.pressed) {
+    return false;
+  }
+
+  bool reverse = get_mods() & MOD_MASK_SHIFT;
+
+  switch (keycode) {
+    case RGB_TOG:
+      rgb_toggle_noeeprom();
+      break;
+    case RGB_MOD:
+    case RGB_RMOD:
+      if ((keycode == RGB_RMOD) != reverse) {
+        rgb_step_reverse_noeeprom();
+      } else {
+        rgb_step_noeeprom();
+      }
+      break;
+    case RGB_HUI:
+    case RGB_HUD:
+      if ((keycode == RGB_HUD) != reverse) {
+        rgb_decrease_hue_noeeprom();
+      } else {
+        rgb_increase_hue_noeeprom();
+      }
+      break;
+    case RGB_SAI:
+    case RGB_SAD:
+      if ((keycode == RGB_SAD) != reverse) {
+        rgb_decrease_sat_noeeprom();
+      } else {
+        rgb_increase_sat_noeeprom();
+      }
+      break;
+    case RGB_VAI:
+    case RGB_VAD:
+      if ((keycode == RGB_VAD) != reverse) {
+        rgb_decrease_val_noeeprom();
+      } else {
+        rgb_increase_val_noeeprom();
+      }
+      break;
+    case RGB_SPI:
+    case RGB_SPD:
+      if ((keycode == RGB_SPD) != reverse) {
+        rgb_decrease_speed_noeeprom();
+      } else {
+        rgb_increase_speed_noeeprom();
+      }
+      break;
+  }
+
+  config_dirty = true;
+  last_change  = timer_read();
+  return false;
+}
+
+void rgb_cache_task(void) {
+  if (config_dirty && timer_elapsed(last_change) >= RGB_CACHE_FLUSH_DELAY) {
+    rgb_cache_flush();
+  }
+}
+
+void rgb_cache_flush(void) {
+  if (config_dirty) {
+    rgb_config_write();
+    config_dirty = false;
+  }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "quantum.h"
+
+// RGB changes are saved to EEPROM once no RGB key has been pressed for this
+// many ms (or on suspend), rather than on every press.
+#ifndef RGB_CACHE_FLUSH_DELAY
+#  define RGB_CACHE_FLUSH_DELAY 3000
+#endif
+
+bool process_rgb_cache(uint16_t keycode, keyrecord_t *record);
+void rgb_cache_task(void);
+void rgb_cache_flush(void);
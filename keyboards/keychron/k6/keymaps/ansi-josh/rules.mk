@@ -1,11 +1,72 @@
 ## Custom
 
-# Set Windows keys
-_K6_WINDOWS = no
+# Custom keycodes send one HID report per event
+SRC += report_batch.c
 
+# Table-driven modifier overrides for custom keycodes (i.e. MAC_EXPOSE)
+SRC += mod_override.c
+
+# Caps Lock position: Esc on tap, Ctrl on hold
+SRC += esc_ctrl.c
+
+# Batch RGB setting changes into one EEPROM write
+SRC += rgb_cache.c
+
+# Scan the matrix at a low rate after a long idle period
+SRC += scan_governor.c
+
+# Light up the keys of the held FN layer while RGB effects are off
+ifeq ($(strip $(RGB_MATRIX_ENABLE)), yes)
+	SRC += layer_leds.c
+endif
+
+# Debounce algorithm: "default" keeps the board's symmetric debounce,
+# "eager_defer" registers presses on the first scan and releases once the
+# switch has read open for DEBOUNCE ms, tracked per key
+K6_DEBOUNCE = default
+
+ifeq ($(strip $(K6_DEBOUNCE)), eager_defer)
+	DEBOUNCE_TYPE = custom
+	SRC += debounce_eager_defer.c
+endif
+
+# Which OS layers to build: "both" switches between macOS and Windows with
+# the dip switch, "mac" or "windows" builds only that OS's three layers
+K6_OS = both
+
+# _K6_WINDOWS = yes, which K6_OS replaced, still builds the Windows layers
 ifeq ($(strip $(_K6_WINDOWS)), yes)
+  ifeq ($(strip $(K6_OS)), mac)
+    $(error _K6_WINDOWS = yes and K6_OS = mac ask for different layers)
+  endif
+	K6_OS = windows
+endif
+
+ifeq ($(strip $(K6_OS)), windows)
 	OPT_DEFS += -D_K6_WINDOWS
+else ifeq ($(strip $(K6_OS)), mac)
+	OPT_DEFS += -D_K6_MAC
 endif
 
 # Enable console for debugging
 # CONSOLE_ENABLE = yes
+
+# Stream scan-to-report latency stats over the console (decode them with
+# scripts/latency-stats.py)
+LATENCY_STATS_ENABLE = no
+
+ifeq ($(strip $(LATENCY_STATS_ENABLE)), yes)
+	CONSOLE_ENABLE = yes
+	OPT_DEFS += -DLATENCY_STATS_ENABLE
+	SRC += latency_histogram.c latency_stats.c
+endif
+
+# Record key events into a ring buffer; FN2 + Esc dumps it to the console
+# (decode it with scripts/key-trace.py)
+KEY_TRACE_ENABLE = no
+
+ifeq ($(strip $(KEY_TRACE_ENABLE)), yes)
+	CONSOLE_ENABLE = yes
+	OPT_DEFS += -DKEY_TRACE_ENABLE
+	SRC += key_trace.c
+endif
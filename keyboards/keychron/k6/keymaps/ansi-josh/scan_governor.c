@@ -0,0 +1,20 @@
+#include "scan_governor.h"
+
+// Times are passed in rather than read here, so this builds on the host and
+// can be driven from a simulated clock.
+
+static uint32_t last_activity;
+
+// Any key event puts the matrix straight back to full rate.
+void scan_governor_activity(uint32_t now) {
+  last_activity = now;
+}
+
+// How long the main loop should sleep before the next scan.
+uint16_t scan_governor_delay(uint32_t now) {
+  if (now - last_activity < SCAN_GOVERNOR_IDLE_TIMEOUT) {
+    return 0;
+  }
+
+  return SCAN_GOVERNOR_IDLE_INTERVAL;
+}
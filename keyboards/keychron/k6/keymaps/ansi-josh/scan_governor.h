@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+// After this many ms without a key event the matrix is scanned at the idle
+// rate instead of as fast as the main loop runs.
+#ifndef SCAN_GOVERNOR_IDLE_TIMEOUT
+#  define SCAN_GOVERNOR_IDLE_TIMEOUT 30000
+#endif
+
+// Time between scans while idle, which is also the most a keystroke after
+// an idle period is delayed by on top of the debounce.
+#ifndef SCAN_GOVERNOR_IDLE_INTERVAL
+#  define SCAN_GOVERNOR_IDLE_INTERVAL 10
+#endif
+
+void     scan_governor_activity(uint32_t now);
+uint16_t scan_governor_delay(uint32_t now);
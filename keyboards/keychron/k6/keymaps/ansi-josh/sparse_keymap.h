@@ -0,0 +1,29 @@
+#pragma once
+
+#include "quantum.h"
+
+// Every physical key on the K6, in LAYOUT_65_ansi argument order. Numbering
+// starts at 1 so that 0 can mark matrix positions that have no switch.
+enum layout_positions {
+  POS_NONE = 0,
+  POS_ESC,  POS_1,    POS_2,    POS_3,    POS_4,    POS_5,    POS_6,    POS_7,    POS_8,    POS_9,    POS_0,    POS_MINS, POS_EQL,  POS_BSPC, POS_LIGHT,
+  POS_TAB,  POS_Q,    POS_W,    POS_E,    POS_R,    POS_T,    POS_Y,    POS_U,    POS_I,    POS_O,    POS_P,    POS_LBRC, POS_RBRC, POS_BSLS, POS_HOME,
+  POS_CAPS, POS_A,    POS_S,    POS_D,    POS_F,    POS_G,    POS_H,    POS_J,    POS_K,    POS_L,    POS_SCLN, POS_QUOT,           POS_ENT,  POS_PGUP,
+  POS_LSFT,           POS_Z,    POS_X,    POS_C,    POS_V,    POS_B,    POS_N,    POS_M,    POS_COMM, POS_DOT,  POS_SLSH,           POS_RSFT, POS_UP,   POS_PGDN,
+  POS_LCTL, POS_LALT, POS_LGUI,                               POS_SPC,                                POS_RGUI, POS_FN1,  POS_FN2,  POS_LEFT, POS_DOWN, POS_RGHT,
+};
+
+// A single non-KC_NO key on an overlay layer.
+typedef struct {
+  uint8_t  position;
+  uint16_t keycode;
+} sparse_key_t;
+
+// An overlay layer stores only its non-KC_NO keys, sorted by position with
+// no repeats.
+typedef struct {
+  const sparse_key_t *keys;
+  uint8_t             count;
+} sparse_layer_t;
+
+#define SPARSE_LAYER(keys) { keys, sizeof(keys) / sizeof(sparse_key_t) }
@@ -0,0 +1,30 @@
+#!/usr/bin/env bash
+
+# Usage: ci-firmware-size.sh
+#
+# Builds the keymap once for each K6_OS mode and prints the flash and RAM
+# each uses. Run from the repo root with SonixQMK cloned into qmk_firmware.
+
+set -e
+
+subdir="keyboards/keychron/k6/keymaps/ansi-josh"
+elf=".build/keychron_k6_rgb_ansi_ansi-josh.elf"
+
+if [[ -d "qmk_firmware/$subdir" ]]; then
+  rm -rf "qmk_firmware/$subdir"
+fi
+
+cp -rp "$subdir" qmk_firmware/keyboards/keychron/k6/keymaps
+
+cd qmk_firmware
+
+printf "%-8s %10s %10s\n" "K6_OS" "flash" "ram"
+
+for os in both mac windows; do
+  # OPT_DEFS changes don't trigger a rebuild, so start clean each time
+  make clean > /dev/null
+  make -j4 keychron/k6/rgb/ansi:ansi-josh COLOR=false K6_OS="$os" > /dev/null
+
+  arm-none-eabi-size "$elf" |
+    awk -v os="$os" 'NR == 2 { printf "%-8s %10d %10d\n", os, $1 + $2, $2 + $3 }'
+done
@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+
+# Usage: gen-fn-layers.py [--check]
+#
+# Expands the sparse FN layer overlays in keymap.c into full LAYOUT_65_ansi
+# layers, with each KC_TRNS replaced by the key on the layer's base layer,
+# and writes them to fn_layers.inc next to keymap.c. keymap.c includes that
+# file in keymaps[]; the overlays themselves aren't built into the firmware.
+#
+# Run it after changing an overlay. With --check it only reports whether
+# fn_layers.inc is up to date, and exits non-zero if not.
+
+import argparse
+import itertools
+import os
+import re
+import sys
+
+KEYMAP_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "keyboards", "keychron", "k6", "keymaps",
+                          "ansi-josh")
+KEYMAP = os.path.join(KEYMAP_DIR, "keymap.c")
+POSITIONS = os.path.join(KEYMAP_DIR, "sparse_keymap.h")
+OUTPUT = os.path.join(KEYMAP_DIR, "fn_layers.inc")
+
+HEADER = """\
+// Generated by scripts/gen-fn-layers.py from the FN layer overlays in
+// keymap.c. Don't edit it, change the overlays and run the script again.
+//
+// Each FN layer in full, with KC_TRNS replaced by the key on its base layer.
+"""
+
+
+class Error(Exception):
+    pass
+
+
+def read_positions(text):
+    """Return the POS_* names, one list per LAYOUT_65_ansi row, from the
+    layout_positions enum."""
+    body = re.search(r"enum layout_positions \{(.*?)\};", text, re.S)
+    if not body:
+        raise Error("sparse_keymap.h: no layout_positions enum")
+
+    rows = []
+    for line in body.group(1).splitlines():
+        names = [name for name in re.findall(r"\bPOS_\w+", line) if name != "POS_NONE"]
+        if names:
+            rows.append(names)
+    return rows
+
+
+def split_arguments(text):
+    """Split a macro argument list at top-level commas."""
+    arguments = []
+    depth = 0
+    current = ""
+    for char in text:
+        if char == "," and depth == 0:
+            arguments.append(current.strip())
+            current = ""
+            continue
+        depth += char == "("
+        depth -= char == ")"
+        current += char
+    if current.strip():
+        arguments.append(current.strip())
+    return arguments
+
+
+def read_base_layers(text):
+    """Return {layer: [keycode, ...]} for the LAYOUT_65_ansi layers."""
+    layers = {}
+    for match in re.finditer(r"\[(\w+)\] = LAYOUT_65_ansi\(", text):
+        depth = 1
+        end = match.end()
+        while depth:
+            depth += {"(": 1, ")": -1}.get(text[end], 0)
+            end += 1
+        body = re.sub(r"//[^\n]*", "", text[match.end():end - 1])
+        layers[match.group(1)] = split_arguments(body)
+    return layers
+
+
+def read_block(text, pattern):
+    """Yield (conditions, line) for each line of the initializer following
+    pattern, where conditions is a tuple of (macro, defined) pairs for the
+    #ifdef blocks the line sits in."""
+    match = re.search(pattern, text)
+    if not match:
+        raise Error("keymap.c: no match for %s" % pattern)
+
+    stack = []
+    for line in text[match.end():].splitlines():
+        stripped = line.strip()
+        if stripped.startswith("};"):
+            return
+        directive = re.match(r"#\s*(ifdef|ifndef|else|endif)\b\s*(\w*)", stripped)
+        if directive:
+            kind, name = directive.groups()
+            if kind in ("ifdef", "ifndef"):
+                stack.append((name, kind == "ifdef"))
+            elif kind == "else":
+                name, defined = stack.pop()
+                stack.append((name, not defined))
+            else:
+                stack.pop()
+            continue
+        yield tuple(stack), line
+
+
+def read_overlay(text, name, index):
+    """Return [(conditions, position, keycode)] for an overlay, checking that
+    it is sorted by position with no repeats."""
+    entries = []
+    previous = 0
+    for conditions, line in read_block(text, r"static const sparse_key_t PROGMEM %s\[\] = \{" % name):
+        for position, keycode in re.findall(r"\{\s*(POS_\w+)\s*,\s*([^{}]+?)\s*\}", line):
+            if position not in index:
+                raise Error("%s: unknown position %s" % (name, position))
+            if index[position] <= previous:
+                raise Error("%s: %s is out of order, overlays must be sorted by position" % (name, position))
+            previous = index[position]
+            entries.append((conditions, position, keycode))
+    return entries
+
+
+def read_fn_layers(text):
+    """Return [(conditions, layer, overlay, base)] from the fn_layers table."""
+    layers = []
+    for conditions, line in read_block(text, r"static const fn_layer_t fn_layers\[\] = \{"):
+        match = re.search(r"\[(\w+) - FN_LAYERS_START\]\s*=\s*\{SPARSE_LAYER\((\w+)\),\s*(\w+)\}", line)
+        if match:
+            layers.append((conditions,) + match.groups())
+    if not layers:
+        raise Error("keymap.c: fn_layers is empty")
+    return layers
+
+
+def condition_expression(conditions):
+    return " && ".join(("defined(%s)" if defined else "!defined(%s)") % name for name, defined in conditions)
+
+
+def condition_directive(conditions):
+    """Return the #ifdef, #ifndef or #if line for a tuple of conditions."""
+    if len(conditions) == 1:
+        name, defined = conditions[0]
+        return "#%s %s\n" % ("ifdef" if defined else "ifndef", name)
+    return "#if %s\n" % condition_expression(conditions)
+
+
+def format_layer(layer, keycodes, rows):
+    cells = []
+    start = 0
+    for row in rows:
+        cells.append([keycode + "," for keycode in keycodes[start:start + len(row)]])
+        start += len(row)
+    cells[-1][-1] = cells[-1][-1][:-1]
+
+    # Line the columns up across rows, as in keymap.c.
+    widths = [max(len(row[column]) for row in cells if column < len(row)) for column in range(len(cells[0]))]
+    lines = ["  " + " ".join(cell.ljust(widths[column]) for column, cell in enumerate(row)).rstrip() for row in cells]
+    return "[%s] = LAYOUT_65_ansi(\n%s\n),\n" % (layer, "\n".join(lines))
+
+
+def generate():
+    with open(POSITIONS) as f:
+        rows = read_positions(f.read())
+    with open(KEYMAP) as f:
+        text = f.read()
+
+    positions = [name for row in rows for name in row]
+    index = {name: i + 1 for i, name in enumerate(positions)}
+    bases = read_base_layers(text)
+
+    output = [HEADER]
+    for layer_conditions, layer, overlay, base in read_fn_layers(text):
+        if base not in bases:
+            raise Error("%s: no base layer %s" % (layer, base))
+        if len(bases[base]) != len(positions):
+            raise Error("%s has %d keys, expected %d" % (base, len(bases[base]), len(positions)))
+
+        entries = read_overlay(text, overlay, index)
+
+        # One layer per combination of the macros the overlay's entries
+        # depend on, since LAYOUT_65_ansi's arguments can't hold #ifdefs.
+        macros = sorted({name for conditions, _, _ in entries for name, _ in conditions})
+        variants = [tuple(zip(macros, values)) for values in itertools.product((True, False), repeat=len(macros))]
+
+        output.append("\n")
+        if layer_conditions:
+            output.append(condition_directive(layer_conditions))
+
+        for i, variant in enumerate(variants):
+            if macros:
+                if i == 0:
+                    output.append(condition_directive(variant))
+                elif i == len(variants) - 1:
+                    output.append("#else\n")
+                else:
+                    output.append("#elif %s\n" % condition_expression(variant))
+
+            keycodes = list(bases[base])
+            overlaid = {}
+            for conditions, position, keycode in entries:
+                if all(condition in variant for condition in conditions):
+                    overlaid[position] = keycode
+            for i_position, position in enumerate(positions):
+                keycode = overlaid.get(position, "KC_NO")
+                if keycode not in ("KC_TRNS", "_______"):
+                    keycodes[i_position] = keycode
+
+            output.append(format_layer(layer, keycodes, rows))
+
+        if macros:
+            output.append("#endif\n")
+        if layer_conditions:
+            output.append("#endif\n")
+
+    return "".join(output)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate fn_layers.inc from the FN layer overlays in keymap.c.")
+    parser.add_argument("--check", action="store_true", help="only check that fn_layers.inc is up to date")
+    args = parser.parse_args()
+
+    try:
+        generated = generate()
+    except Error as error:
+        sys.exit("gen-fn-layers: %s" % error)
+
+    if args.check:
+        try:
+            with open(OUTPUT) as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current != generated:
+            sys.exit("gen-fn-layers: fn_layers.inc is out of date, run scripts/gen-fn-layers.py")
+        return
+
+    with open(OUTPUT, "w") as f:
+        f.write(generated)
+
+
+if __name__ == "__main__":
+    main()
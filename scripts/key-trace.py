@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+
+# Usage: qmk console | key-trace.py [-o trace.k6t]
+#        key-trace.py trace.k6t
+#
+# Decodes the key event trace dumped by a firmware built with
+# KEY_TRACE_ENABLE = yes (FN2 + Esc). Reads the "TRC" console lines from
+# stdin, or a trace file saved earlier with -o, and prints one event per
+# line with its absolute time, matrix position, state and modifiers.
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"K6TR"
+VERSION = 1
+MODS = ["LCTL", "LSFT", "LALT", "LGUI", "RCTL", "RSFT", "RALT", "RGUI"]
+
+
+def read_console(stream):
+    """Return the bytes of the last complete trace dump in the console
+    output, or None if there is none. A line that isn't hex, say one garbled
+    by other console output, drops the dump it is part of."""
+    trace = None
+    chunks = None
+
+    for line in stream:
+        index = line.find("TRC ")
+        if index < 0:
+            continue
+
+        payload = line[index + 4:].strip()
+        if payload == "END":
+            if chunks is not None:
+                trace = b"".join(chunks)
+            chunks = None
+            continue
+
+        try:
+            data = bytes.fromhex(payload)
+        except ValueError:
+            chunks = None
+            continue
+        if data.startswith(MAGIC):
+            chunks = []
+        if chunks is not None:
+            chunks.append(data)
+
+    return trace
+
+
+def parse(trace):
+    """Yield (time_ms, row, col, pressed, mods) for each event in a trace."""
+    if len(trace) < 7 or trace[:4] != MAGIC or trace[4] != VERSION:
+        raise ValueError("not a version %d key trace" % VERSION)
+
+    (count,) = struct.unpack_from("<H", trace, 5)
+    if len(trace) != 7 + count * 4:
+        raise ValueError("trace holds %d bytes of events, expected %d" % (len(trace) - 7, count * 4))
+
+    time = 0
+    for i in range(count):
+        delta, key, mods = struct.unpack_from("<HBB", trace, 7 + i * 4)
+        # The oldest event's delta points at one that was overwritten.
+        time += delta if i else 0
+        yield time, (key >> 4) & 0x7, key & 0xF, bool(key & 0x80), mods
+
+
+def format_mods(mods):
+    names = [name for bit, name in enumerate(MODS) if mods & (1 << bit)]
+    return "+".join(names) if names else "-"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a K6 key event trace.")
+    parser.add_argument("trace", nargs="?", help="trace file saved with -o (default: console output on stdin)")
+    parser.add_argument("-o", "--output", help="save the trace found on stdin to this file")
+    args = parser.parse_args()
+
+    if args.trace:
+        with open(args.trace, "rb") as f:
+            trace = f.read()
+    else:
+        trace = read_console(sys.stdin)
+        if trace is None:
+            sys.exit("key-trace: no complete trace dump found")
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(trace)
+
+    try:
+        events = list(parse(trace))
+    except ValueError as error:
+        sys.exit("key-trace: %s" % error)
+
+    for time, row, col, pressed, mods in events:
+        print("%8d ms  r%d c%-2d %-4s %s" % (time, row, col, "down" if pressed else "up", format_mods(mods)))
+
+
+if __name__ == "__main__":
+    main()
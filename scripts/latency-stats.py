@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+
+# Usage: qmk console | latency-stats.py
+#        latency-stats.py < recorded-console.log
+#
+# Decodes the "LAT <hex>" summaries sent by a firmware built with
+# LATENCY_STATS_ENABLE = yes and prints a scan-to-report latency breakdown.
+# Any other console output is ignored.
+
+import struct
+import sys
+
+STAGES = ["scan", "dispatch", "user", "report", "total"]
+PREFIX = "LAT "
+
+
+def decode(line):
+    """Return (cycles_per_second, [(stage, count, min, avg, p99, max)]) for a
+    summary line, or None if the line is not one."""
+    index = line.find(PREFIX)
+    if index < 0:
+        return None
+
+    try:
+        packet = bytes.fromhex(line[index + len(PREFIX):].strip())
+    except ValueError:
+        return None
+
+    if len(packet) < 6 or packet[0] != 1:
+        return None
+
+    stage_count = packet[1]
+    (cycles_per_second,) = struct.unpack_from("<I", packet, 2)
+    if len(packet) != 6 + stage_count * 20 or cycles_per_second == 0:
+        return None
+
+    stages = []
+    for stage in range(stage_count):
+        name = STAGES[stage] if stage < len(STAGES) else "stage%d" % stage
+        values = struct.unpack_from("<5I", packet, 6 + stage * 20)
+        stages.append((name,) + values)
+
+    return cycles_per_second, stages
+
+
+def format_summary(cycles_per_second, stages):
+    def us(cycles):
+        return "%10.2f" % (cycles * 1e6 / cycles_per_second)
+
+    lines = ["%-10s %10s %10s %10s %10s %10s" % ("stage", "count", "min us", "avg us", "p99 us", "max us")]
+    for name, count, low, avg, p99, high in stages:
+        lines.append("%-10s %10d %s %s %s %s" % (name, count, us(low), us(avg), us(p99), us(high)))
+
+    return "\n".join(lines)
+
+
+def main():
+    for line in sys.stdin:
+        summary = decode(line)
+        if summary is None:
+            continue
+
+        print(format_summary(*summary))
+        print()
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,384 @@
+#include <stdlib.h>
+#include <string.h>
+#include "host.h"
+
+// Feeds the same synthetic switch waveforms to each debounce algorithm and
+// reports what it costs: how long after the contact first closes (or first
+// opens) the debounced matrix changes, and how many changes it makes that
+// the keystrokes don't account for.
+//
+//   bench_debounce [strokes]
+//
+// The algorithms are the board's default, QMK's sym_defer_g, and this
+// keymap's eager_defer (K6_DEBOUNCE = eager_defer). Both are built with
+// their functions renamed so they can run in one binary.
+
+#define DEFAULT_STROKES 2000
+
+// How often the matrix is scanned, roughly what the K6 manages at full rate.
+#ifndef SCAN_INTERVAL_US
+#  define SCAN_INTERVAL_US 250
+#endif
+
+typedef void (*debounce_fn_t)(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+
+void sym_defer_g_init(uint8_t num_rows);
+void sym_defer_g_debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+void eager_defer_init(uint8_t num_rows);
+void eager_defer_debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+
+typedef struct {
+  const char   *name;
+  void        (*init)(uint8_t num_rows);
+  debounce_fn_t debounce;
+} algorithm_t;
+
+static const algorithm_t algorithms[] = {
+  {"sym_defer_g", sym_defer_g_init, sym_defer_g_debounce},
+  {"eager_defer", eager_defer_init, eager_defer_debounce},
+};
+
+// Waveforms
+
+// One edge of one key's switch contact.
+typedef struct {
+  uint32_t time_us;
+  uint8_t  key;
+  bool     closed;
+} edge_t;
+
+// A keystroke as the typist made it, which is what latency is measured
+// from. A glitch is a closure that isn't a keystroke and should be ignored.
+typedef struct {
+  uint8_t  key;
+  uint32_t press_us;
+  uint32_t release_us;
+  bool     glitch;
+} stroke_t;
+
+typedef enum {
+  WAVEFORM_CLEAN,    // no bounce at all
+  WAVEFORM_BOUNCY,   // up to 4 ms of bounce on each edge
+  WAVEFORM_ROLLOVER, // bouncy, with the next key pressed before the last is up
+  WAVEFORM_CHATTER,  // bouncy, and the contact opens briefly while held
+  WAVEFORM_NOISE,    // short closures with no keystroke behind them
+  WAVEFORM_COUNT,
+} waveform_t;
+
+static const char *const waveform_names[] = {
+  [WAVEFORM_CLEAN]    = "clean",
+  [WAVEFORM_BOUNCY]   = "bouncy",
+  [WAVEFORM_ROLLOVER] = "rollover",
+  [WAVEFORM_CHATTER]  = "chatter",
+  [WAVEFORM_NOISE]    = "noise",
+};
+
+// Bounce on an edge never leaves the contact open for DEBOUNCE ms or more,
+// so a perfect debounce makes no false changes on any waveform.
+#define BOUNCE_MAX_US    4000
+#define BOUNCE_EDGES     8
+#define KEY_COUNT        (MATRIX_ROWS * MATRIX_COLS)
+#define EDGES_PER_STROKE (2 * BOUNCE_EDGES + 4)
+
+// The soonest a finger gets a key back down after it has come up.
+#define REPRESS_MIN_US 20000
+
+static stroke_t *strokes;
+static uint32_t  stroke_count;
+static edge_t   *edges;
+static uint32_t  edge_count;
+static uint32_t  random_state;
+
+static uint32_t next_random(void) {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+static uint32_t random_between(uint32_t low, uint32_t high) {
+  return low + next_random() % (high - low + 1);
+}
+
+static void add_edge(uint32_t time_us, uint8_t key, bool closed) {
+  edges[edge_count++] = (edge_t){ .time_us = time_us, .key = key, .closed = closed };
+}
+
+// An edge to closed (or open) at time_us, then a few ms of bounce. Returns
+// when the contact settles. time_us is where the keystroke first shows up
+// on the matrix, which is what latency is measured from.
+static uint32_t add_bouncy_edge(uint32_t time_us, uint8_t key, bool closed) {
+  uint8_t  bounces = next_random() % (BOUNCE_EDGES / 2 + 1);
+  uint32_t end     = time_us + random_between(bounces * 200, BOUNCE_MAX_US);
+  uint32_t time    = time_us;
+
+  add_edge(time, key, closed);
+  for (uint8_t i = 0; i < bounces; i++) {
+    uint32_t left = end - time;
+
+    time += random_between(50, left / (bounces - i) / 2 + 50);
+    add_edge(time, key, !closed);
+    time += random_between(50, left / (bounces - i) / 2 + 50);
+    add_edge(time, key, closed);
+  }
+
+  return time;
+}
+
+// Keys a typist would hit, anywhere in the matrix that has a switch.
+static uint8_t random_key(void) {
+  for (;;) {
+    uint8_t key = next_random() % KEY_COUNT;
+
+    if (keymaps[0][key / MATRIX_COLS][key % MATRIX_COLS] != KC_NO) {
+      return key;
+    }
+  }
+}
+
+static int compare_edges(const void *a, const void *b) {
+  const edge_t *first  = a;
+  const edge_t *second = b;
+
+  if (first->time_us != second->time_us) {
+    return first->time_us < second->time_us ? -1 : 1;
+  }
+  return first->key - second->key;
+}
+
+static void generate(waveform_t waveform, uint32_t count) {
+  uint32_t time                = 10000;
+  uint32_t key_free[KEY_COUNT] = {0};
+
+  random_state = 0x6B36 + waveform;
+  stroke_count = 0;
+  edge_count   = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint8_t   key    = random_key();
+    stroke_t *stroke = &strokes[stroke_count++];
+
+    // A key can't go down again before its last release has settled.
+    if (time < key_free[key]) {
+      time = key_free[key];
+    }
+
+    if (waveform == WAVEFORM_NOISE) {
+      uint32_t width = random_between(100, 900);
+
+      *stroke = (stroke_t){ .key = key, .press_us = time, .release_us = time + width, .glitch = true };
+      add_edge(time, key, true);
+      add_edge(time + width, key, false);
+      key_free[key] = time + width + REPRESS_MIN_US;
+      time += random_between(20000, 200000);
+      continue;
+    }
+
+    uint32_t hold = random_between(40000, 150000);
+
+    *stroke = (stroke_t){ .key = key, .press_us = time, .release_us = time + hold };
+
+    if (waveform == WAVEFORM_CLEAN) {
+      add_edge(time, key, true);
+      add_edge(time + hold, key, false);
+      key_free[key] = time + hold + REPRESS_MIN_US;
+    } else {
+      uint32_t settled = add_bouncy_edge(time, key, true);
+
+      if (waveform == WAVEFORM_CHATTER) {
+        uint32_t open = random_between(settled + 10000, time + hold - 10000);
+
+        add_edge(open, key, false);
+        add_edge(open + random_between(300, 2000), key, true);
+      }
+
+      key_free[key] = add_bouncy_edge(time + hold, key, false) + REPRESS_MIN_US;
+    }
+
+    // Rollover presses the next key while this one is still down.
+    time += waveform == WAVEFORM_ROLLOVER ? random_between(15000, hold - 5000) : hold + random_between(20000, 150000);
+  }
+
+  qsort(edges, edge_count, sizeof(edges[0]), compare_edges);
+}
+
+// Simulation
+
+// One change to the debounced matrix.
+typedef struct {
+  uint32_t time_us;
+  uint8_t  key;
+  bool     on;
+} change_t;
+
+typedef struct {
+  uint32_t samples;
+  uint64_t total_us;
+  uint32_t max_us;
+} latency_t;
+
+typedef struct {
+  latency_t press;
+  latency_t release;
+  uint32_t  false_changes;
+  uint32_t  missed;
+} result_t;
+
+static change_t *changes;
+static uint32_t  change_count;
+
+static void add_latency(latency_t *latency, uint32_t us) {
+  latency->samples++;
+  latency->total_us += us;
+  latency->max_us = us > latency->max_us ? us : latency->max_us;
+}
+
+static bool is_on(const matrix_row_t matrix[], uint8_t key) {
+  return matrix[key / MATRIX_COLS] & ((matrix_row_t)1 << (key % MATRIX_COLS));
+}
+
+static void set_key(matrix_row_t matrix[], uint8_t key, bool on) {
+  matrix_row_t mask = (matrix_row_t)1 << (key % MATRIX_COLS);
+
+  matrix[key / MATRIX_COLS] = on ? matrix[key / MATRIX_COLS] | mask : matrix[key / MATRIX_COLS] & ~mask;
+}
+
+// Scans the waveform into the algorithm and logs the changes it makes.
+static void simulate(const algorithm_t *algorithm) {
+  matrix_row_t raw[MATRIX_ROWS]    = {0};
+  matrix_row_t cooked[MATRIX_ROWS] = {0};
+  matrix_row_t before[MATRIX_ROWS];
+  uint32_t     next_edge = 0;
+  uint32_t     end       = edges[edge_count - 1].time_us + 50000;
+
+  host_time_us = 0;
+  change_count = 0;
+  algorithm->init(MATRIX_ROWS);
+
+  for (; host_time_us < end; host_time_us += SCAN_INTERVAL_US) {
+    bool changed = false;
+
+    for (; next_edge < edge_count && edges[next_edge].time_us <= host_time_us; next_edge++) {
+      const edge_t *edge = &edges[next_edge];
+
+      if (is_on(raw, edge->key) != edge->closed) {
+        set_key(raw, edge->key, edge->closed);
+        changed = true;
+      }
+    }
+
+    memcpy(before, cooked, sizeof(cooked));
+    algorithm->debounce(raw, cooked, MATRIX_ROWS, changed);
+
+    for (uint8_t key = 0; key < KEY_COUNT; key++) {
+      if (is_on(before, key) != is_on(cooked, key)) {
+        changes[change_count++] = (change_t){ .time_us = host_time_us, .key = key, .on = is_on(cooked, key) };
+      }
+    }
+  }
+}
+
+// The first change to key that turns it on (or off) at or after from_us
+// and before until_us, or NULL.
+static const change_t *find_change(uint8_t key, bool on, uint32_t from_us, uint32_t until_us) {
+  for (uint32_t i = 0; i < change_count && changes[i].time_us < until_us; i++) {
+    if (changes[i].key == key && changes[i].on == on && changes[i].time_us >= from_us) {
+      return &changes[i];
+    }
+  }
+  return NULL;
+}
+
+// Matches the changes to the keystrokes. Each keystroke accounts for one
+// press, between it going down and coming up, and one release before the
+// key goes down again; every other change is a false one.
+static result_t score(void) {
+  result_t result  = {0};
+  uint32_t matched = 0;
+
+  for (uint32_t i = 0; i < stroke_count; i++) {
+    const stroke_t *stroke = &strokes[i];
+
+    if (stroke->glitch) {
+      continue;
+    }
+
+    uint32_t next_press = UINT32_MAX;
+
+    for (uint32_t j = i + 1; j < stroke_count; j++) {
+      if (strokes[j].key == stroke->key) {
+        next_press = strokes[j].press_us;
+        break;
+      }
+    }
+
+    const change_t *press = find_change(stroke->key, true, stroke->press_us, stroke->release_us);
+
+    if (!press) {
+      result.missed++;
+      continue;
+    }
+    add_latency(&result.press, press->time_us - stroke->press_us);
+    matched++;
+
+    const change_t *release = find_change(stroke->key, false, stroke->release_us, next_press);
+
+    if (release) {
+      add_latency(&result.release, release->time_us - stroke->release_us);
+      matched++;
+    }
+  }
+
+  result.false_changes = change_count - matched;
+  return result;
+}
+
+static void print_latency(const latency_t *latency) {
+  if (latency->samples) {
+    printf("  %6.2f %6.2f", latency->total_us / 1000.0 / latency->samples, latency->max_us / 1000.0);
+  } else {
+    printf("  %6s %6s", "-", "-");
+  }
+}
+
+int main(int argc, char **argv) {
+  uint32_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_STROKES;
+  bool     clean = true;
+
+  strokes = calloc(count, sizeof(strokes[0]));
+  edges   = calloc(count * EDGES_PER_STROKE, sizeof(edges[0]));
+  changes = calloc(count * EDGES_PER_STROKE, sizeof(changes[0]));
+  host_wait_enabled = false;
+
+  printf("%u keystrokes per waveform, matrix scanned every %u us, DEBOUNCE %u ms\n\n", count, SCAN_INTERVAL_US,
+         DEBOUNCE);
+  printf("%-22s  %13s  %13s  %7s\n", "", "press ms", "release ms", "false");
+  printf("%-9s %-12s  %6s %6s  %6s %6s  %7s %7s\n", "waveform", "algorithm", "avg", "max", "avg", "max", "changes",
+         "missed");
+
+  for (waveform_t waveform = 0; waveform < WAVEFORM_COUNT; waveform++) {
+    generate(waveform, count);
+
+    for (uint8_t i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); i++) {
+      simulate(&algorithms[i]);
+
+      result_t result = score();
+
+      printf("%-9s %-12s", i ? "" : waveform_names[waveform], algorithms[i].name);
+      print_latency(&result.press);
+      print_latency(&result.release);
+      printf("  %7u %7u\n", result.false_changes, result.missed);
+
+      // Both algorithms should get the keystrokes right on anything short of
+      // a switch that chatters or picks up noise.
+      if (waveform <= WAVEFORM_ROLLOVER && (result.false_changes || result.missed)) {
+        clean = false;
+      }
+    }
+  }
+
+  free(strokes);
+  free(edges);
+  free(changes);
+  return clean ? 0 : 1;
+}
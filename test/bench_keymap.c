@@ -0,0 +1,260 @@
+#include <stdlib.h>
+#include <time.h>
+#include "host.h"
+#include "latency_histogram.h"
+#include "sparse_keymap.h"
+
+// Pushes synthetic key events through keymap.c and reports what each one
+// costs on the host: ns per event with a p99 and histogram, and how many HID
+// reports each keystroke sends.
+//
+//   bench_keymap [keystrokes]
+//
+// The events come from a fixed-seed mix of the things this keymap gets used
+// for, so two runs on the same machine are comparable. The report count
+// doesn't depend on the machine: it exits 1 if the mix averages more than
+// MAX_REPORTS_PER_KEYSTROKE, a press and a release.
+
+#define DEFAULT_KEYSTROKES 2000000
+#define MAX_REPORTS_PER_KEYSTROKE 2.0
+
+static const uint8_t letters[] = {
+  POS_Q, POS_W, POS_E, POS_R, POS_T, POS_Y, POS_U, POS_I, POS_O, POS_P,
+  POS_A, POS_S, POS_D, POS_F, POS_G, POS_H, POS_J, POS_K, POS_L,
+  POS_Z, POS_X, POS_C, POS_V, POS_B, POS_N, POS_M, POS_SPC, POS_ENT, POS_BSPC,
+};
+
+// FN1 keys that don't reset the keyboard or need another key to matter.
+static const uint8_t fn1_keys[] = {
+  POS_ESC, POS_1, POS_2, POS_4, POS_7, POS_8, POS_9, POS_0, POS_MINS, POS_EQL,
+  POS_BSPC, POS_P, POS_LBRC, POS_RBRC, POS_UP, POS_LEFT, POS_RGHT, POS_DOWN,
+};
+
+static const uint8_t fn2_keys[] = {
+  POS_1, POS_2, POS_3, POS_4, POS_5, POS_6, POS_7, POS_8, POS_9, POS_0, POS_MINS, POS_EQL,
+  POS_Q, POS_W, POS_E, POS_R, POS_T, POS_Y, POS_U, POS_I, POS_O, POS_P, POS_LBRC, POS_RBRC,
+};
+
+// latency_histogram_t is sized for the device and its buckets saturate at
+// 65535, so samples go through it in batches and the counts pile up here.
+#define HISTOGRAM_BATCH 50000
+
+static latency_histogram_t histogram;
+static uint64_t            bucket_totals[LATENCY_HISTOGRAM_BUCKETS];
+static uint64_t            total_ns;
+static uint32_t            min_ns = UINT32_MAX;
+static uint32_t            max_ns;
+static uint32_t            events;
+static uint32_t            keystrokes;
+static uint32_t            random_state = 0x6B36;
+
+static uint32_t next_random(void) {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+#define PICK(array) (array[next_random() % (sizeof(array) / sizeof(array[0]))])
+
+static uint64_t now_ns(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void fold_histogram(void) {
+  for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    bucket_totals[i] += histogram.buckets[i];
+  }
+  latency_histogram_reset(&histogram);
+}
+
+// Same answer latency_histogram_percentile() gives, over the folded counts.
+static uint32_t percentile(uint8_t percent) {
+  uint64_t target = ((uint64_t)events * percent + 99) / 100;
+  uint64_t seen   = 0;
+
+  for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS - 1; i++) {
+    seen += bucket_totals[i];
+
+    if (seen >= target) {
+      uint32_t bound = latency_histogram_bucket_max(i);
+      return bound < max_ns ? bound : max_ns;
+    }
+  }
+
+  return max_ns;
+}
+
+static void timed_key(uint8_t position, bool pressed) {
+  keypos_t key   = host_position(position);
+  uint64_t start = now_ns();
+
+  host_key(key, pressed);
+
+  uint32_t elapsed = now_ns() - start;
+
+  latency_histogram_add(&histogram, elapsed);
+  if (histogram.count == HISTOGRAM_BATCH) {
+    fold_histogram();
+  }
+
+  total_ns += elapsed;
+  min_ns = elapsed < min_ns ? elapsed : min_ns;
+  max_ns = elapsed > max_ns ? elapsed : max_ns;
+  events++;
+  if (pressed) {
+    keystrokes++;
+  }
+
+  // Typing speed doesn't change the cost, but the Esc/Ctrl and RGB timers
+  // want time to pass between events.
+  host_advance_us(20000 + next_random() % 80000);
+  housekeeping_task_user();
+}
+
+static void tap(uint8_t position) {
+  timed_key(position, true);
+  timed_key(position, false);
+}
+
+static void chord(uint8_t held, uint8_t position) {
+  timed_key(held, true);
+  tap(position);
+  timed_key(held, false);
+}
+
+static void run_mix(uint32_t target) {
+  while (keystrokes < target) {
+    uint32_t kind = next_random() % 100;
+
+    if (kind < 70) {
+      tap(PICK(letters));
+    } else if (kind < 80) {
+      chord(POS_LSFT, PICK(letters));
+    } else if (kind < 86) {
+      chord(POS_FN1, PICK(fn1_keys));
+    } else if (kind < 91) {
+      chord(POS_FN2, PICK(fn2_keys));
+    } else if (kind < 95) {
+      // Exposé, plain or with Ctrl or Cmd held.
+      uint8_t mod = (const uint8_t[]){ 0, POS_LCTL, POS_LGUI }[next_random() % 3];
+
+      if (mod) {
+        timed_key(mod, true);
+      }
+      chord(POS_FN1, POS_3);
+      if (mod) {
+        timed_key(mod, false);
+      }
+    } else if (kind < 98) {
+      tap(POS_CAPS);
+    } else {
+      chord(POS_CAPS, PICK(letters));
+    }
+  }
+}
+
+static double ns_per_call(void (*function)(void), uint32_t calls) {
+  uint64_t start = now_ns();
+
+  for (uint32_t i = 0; i < calls; i++) {
+    function();
+  }
+
+  return (double)(now_ns() - start) / calls;
+}
+
+static void flip_dip_switch(void) {
+  static bool mac;
+
+  mac = !mac;
+  dip_switch_update_user(0, mac);
+}
+
+static volatile uint16_t lookup_sink;
+
+// The benchmark is built with both OSes' layers.
+#define LAYER_COUNT 6
+
+// keymap_key_to_keycode() for every key on every layer.
+static void look_up_all_keys(void) {
+  for (uint8_t layer = 0; layer < LAYER_COUNT; layer++) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+      for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        lookup_sink = keymap_key_to_keycode(layer, (keypos_t){ .col = col, .row = row });
+      }
+    }
+  }
+}
+
+static void print_histogram(void) {
+  uint64_t largest = 0;
+
+  for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    if (bucket_totals[i] > largest) {
+      largest = bucket_totals[i];
+    }
+  }
+
+  printf("\n%12s %10s\n", "ns <=", "events");
+  for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+    if (bucket_totals[i] == 0) {
+      continue;
+    }
+
+    uint8_t bar = bucket_totals[i] * 50 / largest;
+
+    if (i < LATENCY_HISTOGRAM_BUCKETS - 1) {
+      printf("%12u", latency_histogram_bucket_max(i));
+    } else {
+      printf("%12s", "more");
+    }
+    printf(" %10llu ", (unsigned long long)bucket_totals[i]);
+    for (uint8_t j = 0; j < bar; j++) {
+      putchar('#');
+    }
+    putchar('\n');
+  }
+}
+
+int main(int argc, char **argv) {
+  uint32_t target = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_KEYSTROKES;
+
+  host_reset();
+  latency_histogram_reset(&histogram);
+
+  // The clock calls themselves are in every sample, so measure them too.
+  uint64_t overhead_start = now_ns();
+  for (uint32_t i = 0; i < 1000000; i++) {
+    now_ns();
+  }
+  double clock_ns = (double)(now_ns() - overhead_start) / 1000000;
+
+  run_mix(target);
+  fold_histogram();
+
+  uint32_t reports = host_report_count;
+
+  printf("keystrokes         %10u\n", keystrokes);
+  printf("events             %10u\n", events);
+  printf("HID reports        %10u\n", reports);
+  printf("reports/keystroke  %10.3f\n", (double)reports / keystrokes);
+  printf("\n");
+  printf("ns/event   avg %8.1f  min %6u  p50 %6u  p99 %6u  max %8u\n", (double)total_ns / events, min_ns,
+         percentile(50), percentile(99), max_ns);
+  printf("           (includes ~%.0f ns of clock reads per event)\n", clock_ns);
+  printf("ns/lookup  %8.1f  (keymap_key_to_keycode, every layer and key)\n",
+         ns_per_call(look_up_all_keys, 20000) / (LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS));
+  printf("ns/switch  %8.1f  (dip_switch_update_user)\n", ns_per_call(flip_dip_switch, 1000000));
+
+  print_histogram();
+
+  if ((double)reports / keystrokes > MAX_REPORTS_PER_KEYSTROKE) {
+    fprintf(stderr, "bench_keymap: more than %.0f reports per keystroke\n", MAX_REPORTS_PER_KEYSTROKE);
+    return 1;
+  }
+  return 0;
+}
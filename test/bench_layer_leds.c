@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host.h"
+#include "layer_leds.h"
+#include "sparse_keymap.h"
+
+// What each FN layer indicator change costs to draw: how many frames
+// (layer_leds_render() calls) it is spread over, the LED writes per frame,
+// and the host ns per frame. The first frame of each change also walks the
+// keymap for the new layer.
+//
+//   bench_layer_leds [write_us]
+//
+// The frames are drawn twice: once with LED writes taking no time, so each
+// change is as few frames as it can be, and once with each write moving
+// the simulated clock on by write_us (default 5), to show
+// LAYER_LEDS_FRAME_BUDGET_US splitting the work up.
+
+#define DEFAULT_WRITE_US 5
+#define REPEATS          2000
+
+// Enough frames for LAYER_LEDS_SETTLE_TIME to pass and the drawing after.
+#define MAX_FRAMES (LAYER_LEDS_SETTLE_TIME + DRIVER_LED_TOTAL + 10)
+
+typedef struct {
+  const char *name;
+  uint32_t    changes;
+  uint32_t    frames;
+  uint32_t    writes;
+  uint32_t    max_writes;
+  uint64_t    total_ns;
+  uint32_t    max_ns;
+  uint32_t    max_frames;
+} stats_t;
+
+typedef struct {
+  const char *name;
+  void      (*change)(void);
+  bool        lit; // whether an FN layer is held afterwards
+} step_t;
+
+static void fn1_on(void) {
+  host_press(POS_FN1);
+}
+
+static void fn2_on(void) {
+  host_press(POS_FN2);
+}
+
+static void fn2_off(void) {
+  host_release(POS_FN2);
+}
+
+static void fn1_off(void) {
+  host_release(POS_FN1);
+}
+
+// RGB effects switched off while FN1 is held: RGB matrix blanks every LED,
+// so the indicator is drawn again from scratch once that has settled.
+static void effects_off(void) {
+  rgb_matrix_toggle_noeeprom();
+  layer_leds_render();
+  host_press(POS_FN1);
+  layer_leds_render();
+  rgb_matrix_toggle_noeeprom();
+}
+
+static stats_t stats[2][5];
+
+static uint64_t now_ns(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static uint8_t held_layer(void) {
+  return get_highest_layer(layer_state | default_layer_state);
+}
+
+// Every LED lit in the layer's color if its key does something there, dark
+// otherwise.
+static bool leds_show(uint8_t layer, bool lit) {
+  for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+      uint8_t led = g_led_config.matrix_co[row][col];
+
+      if (led == NO_LED) {
+        continue;
+      }
+
+      bool on = lit && keymap_key_to_keycode(layer, (keypos_t){ .col = col, .row = row }) != KC_NO;
+      bool is = host_leds[led][0] || host_leds[led][1] || host_leds[led][2];
+
+      if (on != is) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Renders a frame a ms until the change is drawn, adding it to stats.
+static bool draw(stats_t *stats, bool lit) {
+  uint32_t frames = 0;
+
+  stats->changes++;
+
+  for (uint32_t frame = 0; frame < MAX_FRAMES; frame++) {
+    uint32_t writes = host_led_writes;
+
+    host_advance_ms(1);
+
+    uint64_t start = now_ns();
+    layer_leds_render();
+    uint32_t elapsed = now_ns() - start;
+
+    writes = host_led_writes - writes;
+    if (writes == 0) {
+      continue;
+    }
+
+    frames++;
+    stats->frames++;
+    stats->writes += writes;
+    stats->total_ns += elapsed;
+    stats->max_writes = writes > stats->max_writes ? writes : stats->max_writes;
+    stats->max_ns     = elapsed > stats->max_ns ? elapsed : stats->max_ns;
+  }
+
+  stats->max_frames = frames > stats->max_frames ? frames : stats->max_frames;
+  return leds_show(held_layer(), lit);
+}
+
+static const step_t steps[] = {
+  {"FN1 on",                fn1_on,      true},
+  {"FN1 off",               fn1_off,     false},
+  {"FN2 on",                fn2_on,      true},
+  {"FN2 off",               fn2_off,     false},
+  {"effects off, FN1 held", effects_off, true},
+  {"FN1 off",               fn1_off,     false},
+};
+
+// Which stats each step adds to; the two FN1 offs go together.
+static const uint8_t step_stats[] = {0, 1, 2, 3, 4, 1};
+
+static bool run(uint32_t write_us, bool mac, stats_t *table) {
+  bool ok = true;
+
+  host_dip_switch_mac = mac;
+  host_reset();
+  host_led_write_us = write_us;
+
+  for (uint32_t repeat = 0; repeat < REPEATS; repeat++) {
+    for (uint8_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+      stats_t *stats = &table[step_stats[i]];
+
+      stats->name = steps[i].name;
+      steps[i].change();
+      if (!draw(stats, steps[i].lit)) {
+        fprintf(stderr, "bench_layer_leds: LEDs wrong after %s\n", steps[i].name);
+        ok = false;
+      }
+    }
+  }
+
+  host_led_write_us = 0;
+  return ok;
+}
+
+static void print_table(const char *title, const stats_t *table) {
+  printf("%s\n", title);
+  printf("%-24s %15s  %13s  %17s\n", "", "frames", "writes", "ns/frame");
+  printf("%-24s %7s %7s  %6s %6s  %8s %8s\n", "change", "avg", "max", "avg", "max", "avg", "max");
+
+  for (uint8_t i = 0; i < 5; i++) {
+    const stats_t *stats = &table[i];
+
+    printf("%-24s %7.1f %7u  %6.1f %6u  %8.0f %8u\n", stats->name, (double)stats->frames / stats->changes,
+           stats->max_frames, (double)stats->writes / stats->frames, stats->max_writes,
+           (double)stats->total_ns / stats->frames, stats->max_ns);
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv) {
+  uint32_t write_us = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_WRITE_US;
+  bool     ok       = true;
+
+  printf("LAYER_LEDS_FRAME_BUDGET_US %u, %u changes each\n\n", LAYER_LEDS_FRAME_BUDGET_US, REPEATS);
+
+  for (uint8_t os = 0; os < 2; os++) {
+    bool mac = os == 0;
+
+    ok &= run(0, mac, stats[0]);
+    ok &= run(write_us, mac, stats[1]);
+
+    char title[80];
+
+    snprintf(title, sizeof(title), "%s, LED writes free:", mac ? "macOS" : "Windows");
+    print_table(title, stats[0]);
+    snprintf(title, sizeof(title), "%s, LED writes %u us each:", mac ? "macOS" : "Windows", write_us);
+    print_table(title, stats[1]);
+
+    memset(stats, 0, sizeof(stats));
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+#include <stdlib.h>
+#include <string.h>
+#include "debounce.h"
+#include "host.h"
+#include "scan_governor.h"
+#include "trace_file.h"
+
+// Runs QMK's main loop against a simulated clock: scan the matrix, debounce
+// it (the board's default sym_defer_g), send any key events through the
+// keymap, then the housekeeping task, where the scan governor may sleep.
+// The matrix is driven from recorded typing traces, each played over and
+// over with idle gaps in between, some shorter than
+// SCAN_GOVERNOR_IDLE_TIMEOUT and some longer.
+//
+//   bench_scan_governor trace.k6t...
+//
+// It prints how much of the time the matrix was scanned at full rate or at
+// the idle rate, and how long after the switch closed each keystroke became
+// a key event, split by whether the governor was idle when it closed.
+// Exits 1 if a keystroke after an idle period took longer than
+// SCAN_GOVERNOR_IDLE_INTERVAL plus the debounce.
+
+// How long a scan, the key events and housekeeping take at full rate.
+#ifndef SCAN_INTERVAL_US
+#  define SCAN_INTERVAL_US 250
+#endif
+
+#ifndef DEBOUNCE
+#  define DEBOUNCE 5
+#endif
+
+#define ROUNDS 8
+
+// Idle gaps between plays of a trace, in ms. The clock is 32-bit us, so one
+// trace's rounds have to fit in about 70 minutes.
+static const uint32_t gaps_ms[] = {1000, 5000, 20000, 29000, 31000, 45000, 90000, 180000};
+
+typedef enum {
+  STATE_FULL_RATE,  // a key event within SCAN_GOVERNOR_IDLE_TIMEOUT
+  STATE_IDLE_AWAKE, // idle, but kept awake by the debounce
+  STATE_IDLE_SLEEP, // idle and sleeping between scans
+  STATE_COUNT,
+} state_t;
+
+static const char *const state_names[] = {
+  [STATE_FULL_RATE]  = "full rate",
+  [STATE_IDLE_AWAKE] = "idle, debouncing",
+  [STATE_IDLE_SLEEP] = "idle, sleeping",
+};
+
+typedef struct {
+  uint32_t count;
+  uint64_t total_us;
+  uint32_t max_us;
+} latency_t;
+
+static uint64_t  state_us[STATE_COUNT];
+static uint64_t  state_scans[STATE_COUNT];
+static latency_t active_presses;
+static latency_t wake_presses;
+
+static matrix_row_t raw[MATRIX_ROWS];
+static matrix_row_t cooked[MATRIX_ROWS];
+static matrix_row_t previous_raw[MATRIX_ROWS];
+
+// When each key's switch closed, if its press hasn't reached the keymap yet,
+// and whether the governor was idle at that time.
+static uint32_t closed_us[MATRIX_ROWS][MATRIX_COLS];
+static bool     closed_idle[MATRIX_ROWS][MATRIX_COLS];
+
+static uint32_t random_state = 0x6B36;
+
+static uint32_t next_random(void) {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+static bool governor_idle(void) {
+  return scan_governor_delay(timer_read32()) != 0;
+}
+
+static void add_latency(latency_t *latency, uint32_t us) {
+  latency->count++;
+  latency->total_us += us;
+  latency->max_us = us > latency->max_us ? us : latency->max_us;
+}
+
+// One pass of the main loop.
+static void scan(void) {
+  uint32_t start   = host_time_us;
+  bool     idle    = governor_idle();
+  bool     changed = memcmp(raw, previous_raw, sizeof(raw)) != 0;
+
+  memcpy(previous_raw, raw, sizeof(raw));
+
+  matrix_row_t before[MATRIX_ROWS];
+
+  memcpy(before, cooked, sizeof(cooked));
+  debounce(raw, cooked, MATRIX_ROWS, changed);
+
+  for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+    matrix_row_t diff = before[row] ^ cooked[row];
+
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+      if (!(diff & (1 << col))) {
+        continue;
+      }
+
+      bool pressed = cooked[row] & (1 << col);
+
+      if (pressed) {
+        add_latency(closed_idle[row][col] ? &wake_presses : &active_presses, host_time_us - closed_us[row][col]);
+      }
+      host_key((keypos_t){ .row = row, .col = col }, pressed);
+    }
+  }
+
+  housekeeping_task_user();
+
+  state_t state = !idle ? STATE_FULL_RATE : host_time_us != start ? STATE_IDLE_SLEEP : STATE_IDLE_AWAKE;
+
+  if (host_time_us == start) {
+    host_advance_us(SCAN_INTERVAL_US);
+  }
+  state_us[state] += host_time_us - start;
+  state_scans[state]++;
+}
+
+static void run_until(uint32_t time_us) {
+  while (host_time_us < time_us) {
+    scan();
+  }
+}
+
+// The switch changes at time_us, which the scan that sees it may be some
+// way past if the governor was sleeping.
+static void set_switch(uint8_t row, uint8_t col, bool closed, uint32_t time_us) {
+  if (closed) {
+    raw[row] |= 1 << col;
+    closed_us[row][col]   = time_us;
+    closed_idle[row][col] = scan_governor_delay(time_us / 1000) != 0;
+  } else {
+    raw[row] &= ~(1 << col);
+  }
+}
+
+// Plays the trace's events at their recorded times, from time_us.
+static void play(const uint8_t *events, uint16_t count, uint32_t time_us) {
+  for (uint16_t i = 0; i < count; i++) {
+    const uint8_t *event = &events[i * TRACE_EVENT_BYTES];
+    uint16_t       delta = event[0] | event[1] << 8;
+    uint8_t        key   = event[2];
+
+    // The oldest event's delta points at one that was overwritten.
+    time_us += i ? delta * 1000 : 0;
+    run_until(time_us);
+    set_switch((key >> 4) & 0x7, key & 0xF, key & 0x80, time_us);
+  }
+
+  // Let go of anything the trace left held.
+  run_until(time_us + 1000);
+  memset(raw, 0, sizeof(raw));
+}
+
+static bool simulate(const char *path) {
+  uint16_t count;
+  uint8_t *trace = trace_file_read(path, &count);
+
+  if (!trace) {
+    return false;
+  }
+
+  // Power on at time 0, with the governor at full rate as after a key event.
+  host_time_us = 0;
+  host_reset();
+  debounce_init(MATRIX_ROWS);
+  scan_governor_activity(0);
+  memset(raw, 0, sizeof(raw));
+  memset(cooked, 0, sizeof(cooked));
+  memset(previous_raw, 0, sizeof(previous_raw));
+
+  for (uint8_t round = 0; round < ROUNDS; round++) {
+    for (uint8_t gap = 0; gap < sizeof(gaps_ms) / sizeof(gaps_ms[0]); gap++) {
+      // Land the first keystroke anywhere in the idle interval's sleep.
+      uint32_t jitter = next_random() % (SCAN_GOVERNOR_IDLE_INTERVAL * 1000);
+
+      play(&trace[TRACE_HEADER_BYTES], count, host_time_us + gaps_ms[gap] * 1000 + jitter);
+    }
+  }
+
+  free(trace);
+  return true;
+}
+
+static void print_latency(const char *name, const latency_t *latency) {
+  printf("%-26s %7u %9.2f %9.2f\n", name, latency->count,
+         latency->count ? latency->total_us / 1000.0 / latency->count : 0.0, latency->max_us / 1000.0);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: bench_scan_governor trace.k6t...\n");
+    return 2;
+  }
+
+  for (int i = 1; i < argc; i++) {
+    if (!simulate(argv[i])) {
+      return 1;
+    }
+  }
+
+  uint64_t total_us = 0;
+
+  for (uint8_t state = 0; state < STATE_COUNT; state++) {
+    total_us += state_us[state];
+  }
+
+  printf("SCAN_GOVERNOR_IDLE_TIMEOUT %u ms, SCAN_GOVERNOR_IDLE_INTERVAL %u ms, DEBOUNCE %u ms, %.1f min simulated\n\n",
+         SCAN_GOVERNOR_IDLE_TIMEOUT, SCAN_GOVERNOR_IDLE_INTERVAL, DEBOUNCE, total_us / 60e6);
+
+  printf("%-26s %7s %12s\n", "state", "time", "scans");
+  for (uint8_t state = 0; state < STATE_COUNT; state++) {
+    printf("%-26s %6.1f%% %12llu\n", state_names[state], 100.0 * state_us[state] / total_us,
+           (unsigned long long)state_scans[state]);
+  }
+
+  printf("\n%-26s %7s %9s %9s\n", "switch close to key event", "presses", "avg ms", "max ms");
+  print_latency("at full rate", &active_presses);
+  print_latency("after an idle period", &wake_presses);
+
+  uint32_t limit_us = (SCAN_GOVERNOR_IDLE_INTERVAL + DEBOUNCE) * 1000 + SCAN_INTERVAL_US;
+
+  if (wake_presses.count == 0 || wake_presses.max_us > limit_us) {
+    fprintf(stderr, "bench_scan_governor: worst press after an idle period should be under %.2f ms\n",
+            limit_us / 1000.0);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include <string.h>
+#include "esc_ctrl.h"
+#include "host.h"
+#include "sparse_keymap.h"
+
+// Taps every key on every layer one OS can reach and prints the reports
+// each tap sent. make builds it with both OSes' layers and once for each
+// K6_OS mode, and diffs the single-OS output against the both-OS output
+// with the dip switch set to that OS, so leaving the other OS out of the
+// build changes nothing that reaches the host.
+//
+//   os_keys [-w]
+//
+// -w sets the dip switch to Windows. A single-OS build ignores it.
+
+// Keys held while each key is tapped: no FN key, FN1 and FN2, each alone
+// and with the modifiers the mod overrides and Exposé keys look at.
+static const uint8_t fn_keys[]  = {POS_NONE, POS_FN1, POS_FN2};
+static const uint8_t mod_keys[] = {POS_NONE, POS_LSFT, POS_LCTL, POS_LALT, POS_LGUI};
+
+static const char *position_name(uint8_t position) {
+  switch (position) {
+    case POS_FN1:
+      return "FN1";
+    case POS_FN2:
+      return "FN2";
+    case POS_LSFT:
+      return "LSFT";
+    case POS_LCTL:
+      return "LCTL";
+    case POS_LALT:
+      return "LALT";
+    case POS_LGUI:
+      return "LGUI";
+    default:
+      return "";
+  }
+}
+
+// Every key tapped with fn and mod held, from a fresh keyboard so that RGB
+// keys and the like tapped under one combination don't carry over.
+static void tap_all(bool mac, uint8_t fn, uint8_t mod) {
+  host_dip_switch_mac = mac;
+  host_reset();
+  host_idle_ms(1);
+
+  printf("== %s%s%s\n", position_name(fn), fn && mod ? "+" : "", fn || mod ? position_name(mod) : "base");
+
+  if (mod) {
+    host_press(mod);
+  }
+  if (fn) {
+    host_press(fn);
+  }
+  host_idle_ms(ESC_CTRL_TAP_TERM + 10);
+  host_print_new_reports(stdout);
+
+  for (uint8_t position = POS_ESC; position <= POS_RGHT; position++) {
+    if (position == fn || position == mod) {
+      continue;
+    }
+
+    uint32_t jumps = host_bootloader_jumps;
+
+    printf("%10.3f ms  key %u\n", host_time_us / 1000.0, position);
+    host_press(position);
+    host_idle_ms(20);
+    host_release(position);
+    host_idle_ms(20);
+    host_print_new_reports(stdout);
+    if (host_bootloader_jumps != jumps) {
+      printf("  bootloader\n");
+    }
+  }
+
+  if (fn) {
+    host_release(fn);
+  }
+  if (mod) {
+    host_release(mod);
+  }
+  host_idle_ms(1000);
+  host_print_new_reports(stdout);
+}
+
+int main(int argc, char **argv) {
+  bool windows = argc == 2 && strcmp(argv[1], "-w") == 0;
+
+  if (argc != 1 + windows) {
+    fprintf(stderr, "usage: os_keys [-w]\n");
+    return 2;
+  }
+
+  for (uint8_t fn = 0; fn < sizeof(fn_keys); fn++) {
+    for (uint8_t mod = 0; mod < sizeof(mod_keys); mod++) {
+      tap_all(!windows, fn_keys[fn], mod_keys[mod]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include "ansi.h"
+#include "host.h"
+
+// The steps QMK takes for one key event: find the layer the key resolves on,
+// run the process_record chain and, if nothing stopped it, the basic keycode
+// action and post_process_record_user.
+
+// Layer each key was pressed on. Releases resolve on the same layer even if
+// the layer state changed in between, like QMK's source layer cache.
+static uint8_t source_layers[MATRIX_ROWS][MATRIX_COLS];
+
+__attribute__((weak)) uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+  return pgm_read_word(&keymaps[layer][key.row][key.col]);
+}
+
+__attribute__((weak)) bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+  return true;
+}
+
+__attribute__((weak)) void post_process_record_user(uint16_t keycode, keyrecord_t *record) {}
+
+// Highest active layer where the key isn't KC_TRNS.
+static uint8_t layer_for_key(keypos_t key) {
+  layer_state_t layers = layer_state | default_layer_state;
+
+  for (int8_t layer = 31; layer >= 0; layer--) {
+    if ((layers & ((layer_state_t)1 << layer)) && keymap_key_to_keycode(layer, key) != KC_TRNS) {
+      return layer;
+    }
+  }
+
+  return 0;
+}
+
+// The quantum keycodes the keymap can reach. process_rgb saves every change
+// to EEPROM straight away.
+static bool process_quantum(uint16_t keycode, keyrecord_t *record) {
+  if (keycode == RESET) {
+    if (record->event.pressed) {
+      reset_keyboard();
+    }
+    return false;
+  }
+
+  if (keycode >= RGB_TOG && keycode <= RGB_SPD) {
+    if (record->event.pressed) {
+      if (keycode == RGB_TOG) {
+        rgb_matrix_toggle_noeeprom();
+      }
+      eeconfig_update_rgb_matrix();
+    }
+    return false;
+  }
+
+  return true;
+}
+
+static void process_action(uint16_t keycode, bool pressed) {
+  if (keycode >= QK_MOMENTARY && keycode <= QK_MOMENTARY_MAX) {
+    if (pressed) {
+      layer_on(keycode & 0xFF);
+    } else {
+      layer_off(keycode & 0xFF);
+    }
+    return;
+  }
+
+  if (keycode <= 0xFF) {
+    if (pressed) {
+      register_code(keycode);
+    } else {
+      unregister_code(keycode);
+    }
+  }
+}
+
+void host_key(keypos_t key, bool pressed) {
+  keyrecord_t record = {
+    .event = { .key = key, .pressed = pressed, .time = timer_read() | 1 },
+  };
+
+  if (pressed) {
+    source_layers[key.row][key.col] = layer_for_key(key);
+  }
+
+  uint16_t keycode = keymap_key_to_keycode(source_layers[key.row][key.col], key);
+
+  if (!process_record_user(keycode, &record) || !process_quantum(keycode, &record)) {
+    return;
+  }
+
+  process_action(keycode, pressed);
+  post_process_record_user(keycode, &record);
+}
+
+uint16_t host_keycode(keypos_t key) {
+  return keymap_key_to_keycode(layer_for_key(key), key);
+}
+
+void host_press(uint8_t position) {
+  host_key(host_position(position), true);
+}
+
+void host_release(uint8_t position) {
+  host_key(host_position(position), false);
+}
+
+void host_tap(uint8_t position) {
+  host_press(position);
+  host_release(position);
+}
+
+void host_idle_until(uint32_t time_us) {
+  while (host_time_us < time_us) {
+    uint32_t before = host_time_us;
+
+    housekeeping_task_user();
+
+    // A wait_ms() in the housekeeping task already moved the clock on.
+    if (host_time_us == before) {
+      uint32_t step = time_us - host_time_us;
+      host_advance_us(step < 1000 ? step : 1000);
+    }
+  }
+}
+
+void host_idle_ms(uint32_t ms) {
+  host_idle_until(host_time_us + ms * 1000);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// Stand-in for keychron/k6/rgb/ansi/ansi.h, what QMK_KEYBOARD_H names when
+// building the keymap. The matrix wiring is the usual QMK 65% layout, not
+// copied from the K6 board files, which aren't in this tree. Replayed key
+// traces use these row/col numbers, so a trace recorded on the keyboard only
+// replays the right keys once this LAYOUT_65_ansi matches the board's.
+
+#include "quantum.h"
+
+#define LAYOUT_65_ansi( \
+  k00, k01, k02, k03, k04, k05, k06, k07, k08, k09, k0a, k0b, k0c, k0d, k0f, \
+  k10, k11, k12, k13, k14, k15, k16, k17, k18, k19, k1a, k1b, k1c, k1d, k1f, \
+  k20, k21, k22, k23, k24, k25, k26, k27, k28, k29, k2a, k2b,      k2d, k2f, \
+  k30,      k32, k33, k34, k35, k36, k37, k38, k39, k3a, k3b,      k3d, k3e, k3f, \
+  k40, k41, k42,                k46,                k4a, k4b, k4c, k4d, k4e, k4f \
+) { \
+  { k00,   k01,   k02,   k03,   k04,   k05,   k06,   k07,   k08,   k09,   k0a,   k0b,   k0c,   k0d,   KC_NO, k0f }, \
+  { k10,   k11,   k12,   k13,   k14,   k15,   k16,   k17,   k18,   k19,   k1a,   k1b,   k1c,   k1d,   KC_NO, k1f }, \
+  { k20,   k21,   k22,   k23,   k24,   k25,   k26,   k27,   k28,   k29,   k2a,   k2b,   KC_NO, k2d,   KC_NO, k2f }, \
+  { k30,   KC_NO, k32,   k33,   k34,   k35,   k36,   k37,   k38,   k39,   k3a,   k3b,   KC_NO, k3d,   k3e,   k3f }, \
+  { k40,   k41,   k42,   KC_NO, KC_NO, KC_NO, k46,   KC_NO, KC_NO, KC_NO, k4a,   k4b,   k4c,   k4d,   k4e,   k4f } \
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+// The ChibiOS system time and SysTick registers cycle_clock.h reads, made
+// from the host clock as if the core ran at 48MHz with a 1kHz tick. Both
+// move in whole µs, so cycle counts come out in steps of 48.
+
+#define CH_CFG_ST_FREQUENCY 1000
+#define CH_CFG_ST_TIMEDELTA 0
+#define HOST_CPU_FREQUENCY  48000000
+
+typedef uint32_t systime_t;
+
+typedef struct {
+  uint32_t LOAD;
+  uint32_t VAL;
+} host_systick_t;
+
+extern uint32_t host_time_us;
+
+static inline systime_t chVTGetSystemTimeX(void) {
+  return host_time_us / 1000;
+}
+
+// SysTick counts down from LOAD to 0 once per tick.
+static inline host_systick_t *host_systick(void) {
+  static host_systick_t systick;
+  uint32_t              cycles_per_tick = HOST_CPU_FREQUENCY / CH_CFG_ST_FREQUENCY;
+
+  systick.LOAD = cycles_per_tick - 1;
+  systick.VAL  = systick.LOAD - (host_time_us % 1000) * (cycles_per_tick / 1000);
+  return &systick;
+}
+
+#define SysTick (host_systick())
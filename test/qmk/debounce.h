@@ -0,0 +1,11 @@
+#pragma once
+
+#include "quantum.h"
+
+// QMK's debounce interface, which turns the raw matrix into the one key
+// events are taken from.
+
+void debounce_init(uint8_t num_rows);
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+bool debounce_active(void);
+void debounce_free(void);
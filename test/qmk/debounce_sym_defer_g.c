@@ -0,0 +1,37 @@
+#include "debounce.h"
+
+// QMK's default debounce, quantum/debounce/sym_defer_g.c: once the raw
+// matrix has stopped changing for DEBOUNCE ms, all of it is taken as is.
+// Presses and releases both wait, and a key bouncing holds up every other
+// key changing at the same time.
+
+#ifndef DEBOUNCE
+#  define DEBOUNCE 5
+#endif
+
+static bool     debouncing;
+static uint16_t debouncing_time;
+
+void debounce_init(uint8_t num_rows) {
+  debouncing = false;
+}
+
+bool debounce_active(void) {
+  return debouncing;
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+  if (changed) {
+    debouncing      = true;
+    debouncing_time = timer_read();
+  }
+
+  if (debouncing && timer_elapsed(debouncing_time) >= DEBOUNCE) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+      cooked[row] = raw[row];
+    }
+    debouncing = false;
+  }
+}
+
+void debounce_free(void) {}
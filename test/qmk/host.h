@@ -0,0 +1,112 @@
+#pragma once
+
+// What the host tests and benchmarks see of the stand-in QMK: a simulated
+// clock, a log of everything sent over USB, and a way to feed key events
+// through the same steps QMK takes for them.
+
+#include <stdio.h>
+#include "quantum.h"
+
+// Simulated time. timer_read() and friends are derived from it, and wait_ms()
+// advances it (unless host_wait_enabled is cleared).
+extern uint32_t host_time_us;
+extern bool     host_wait_enabled;
+
+void host_advance_us(uint32_t us);
+void host_advance_ms(uint32_t ms);
+
+// Every report sent to the host. All of them are counted; the first
+// HOST_REPORT_LOG_SIZE since host_reset() are also kept.
+typedef enum {
+  HOST_KEYBOARD,
+  HOST_CONSUMER,
+  HOST_SYSTEM,
+} host_report_type_t;
+
+typedef struct {
+  uint32_t           time_us;
+  host_report_type_t type;
+  uint8_t            mods;
+  uint8_t            keys[6];
+  uint16_t           usage;
+} host_report_t;
+
+#define HOST_REPORT_LOG_SIZE 4096
+
+extern host_report_t host_reports[HOST_REPORT_LOG_SIZE];
+extern uint32_t      host_report_count;
+
+void host_print_report(FILE *out, const host_report_t *report);
+bool host_report_has_key(const host_report_t *report, uint8_t code);
+
+// The latest report kept in host_reports, NULL before anything was sent.
+const host_report_t *host_last_report(void);
+
+// Prints the kept reports sent since the last call or host_reset(), each
+// indented to sit under a line about what caused them.
+void host_print_new_reports(FILE *out);
+
+// Side effects that never reach a report.
+extern uint32_t host_bootloader_jumps;
+extern uint32_t host_led_writes;
+extern uint8_t  host_leds[DRIVER_LED_TOTAL][3];
+
+// How far each rgb_matrix_set_color() moves the clock on, 0 unless a test or
+// benchmark wants LED writes to take time.
+extern uint32_t host_led_write_us;
+
+// RGB matrix settings, as QMK keeps them in rgb_matrix_config: the live ones
+// in RAM and the saved ones in a simulated EEPROM. Each save counts as one
+// write, and host_eeprom_bytes_written counts the bytes it changed, as
+// eeprom_update_block() only writes those.
+typedef struct {
+  bool    enable;
+  uint8_t mode;
+  uint8_t hue;
+  uint8_t sat;
+  uint8_t val;
+  uint8_t speed;
+} host_rgb_config_t;
+
+#define HOST_RGB_MODES 8
+
+extern host_rgb_config_t host_rgb_config;
+extern host_rgb_config_t host_eeprom_rgb_config;
+extern uint32_t          host_eeprom_writes;
+extern uint32_t          host_eeprom_bytes_written;
+
+// Everything printed with uprintf() since host_reset(), NUL-terminated.
+#define HOST_CONSOLE_SIZE 65536
+
+extern char   host_console[HOST_CONSOLE_SIZE];
+extern size_t host_console_length;
+
+// Puts the keyboard back to power-on state and runs the keymap's init hooks.
+// The Mac/Win dip switch reads as Mac unless set otherwise beforehand.
+// host_reset() starts from a fresh EEPROM, host_power_cycle() keeps what was
+// saved to it.
+extern bool host_dip_switch_mac;
+
+void host_reset(void);
+void host_power_cycle(void);
+
+// One key event through QMK's pipeline: layer lookup, process_record_user,
+// the quantum and basic keycode handling, post_process_record_user.
+void host_key(keypos_t key, bool pressed);
+
+// Keycode a press of key gets under the current layer state, found with the
+// same layer walk as host_key().
+uint16_t host_keycode(keypos_t key);
+
+// Matrix position of a key, by its 1-based LAYOUT_65_ansi argument index.
+// That's what sparse_keymap.h's POS_ESC etc. are.
+keypos_t host_position(uint8_t position);
+
+void host_press(uint8_t position);
+void host_release(uint8_t position);
+void host_tap(uint8_t position);
+
+// Runs housekeeping_task_user() every ms until the clock reaches time_us,
+// or for ms from now.
+void host_idle_until(uint32_t time_us);
+void host_idle_ms(uint32_t ms);
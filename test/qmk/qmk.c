@@ -0,0 +1,497 @@
+#include <stdarg.h>
+#include "ansi.h"
+#include "host.h"
+
+// Keyboard state, reports, layers, timers, RGB and console for the stand-in
+// QMK. Each piece does what QMK does as far as the keymap can tell.
+
+uint32_t host_time_us;
+bool     host_wait_enabled = true;
+
+host_report_t host_reports[HOST_REPORT_LOG_SIZE];
+uint32_t      host_report_count;
+
+uint32_t host_bootloader_jumps;
+uint32_t host_led_writes;
+uint8_t  host_leds[DRIVER_LED_TOTAL][3];
+uint32_t host_led_write_us;
+
+host_rgb_config_t host_rgb_config;
+host_rgb_config_t host_eeprom_rgb_config;
+uint32_t          host_eeprom_writes;
+uint32_t          host_eeprom_bytes_written;
+
+char   host_console[HOST_CONSOLE_SIZE];
+size_t host_console_length;
+
+bool host_dip_switch_mac = true;
+
+layer_state_t layer_state;
+layer_state_t default_layer_state;
+led_config_t  g_led_config;
+
+bool debug_enable;
+bool debug_matrix;
+bool debug_keyboard;
+bool debug_mouse;
+
+static uint8_t real_mods;
+static uint8_t weak_mods;
+static uint8_t report_keys[6];
+
+// How far host_print_new_reports() has got.
+static uint32_t printed_reports;
+
+// Clock
+
+void host_advance_us(uint32_t us) {
+  host_time_us += us;
+}
+
+void host_advance_ms(uint32_t ms) {
+  host_time_us += ms * 1000;
+}
+
+uint16_t timer_read(void) {
+  return host_time_us / 1000;
+}
+
+uint32_t timer_read32(void) {
+  return host_time_us / 1000;
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+  return TIMER_DIFF_16(timer_read(), last);
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+  return TIMER_DIFF_32(timer_read32(), last);
+}
+
+void wait_ms(uint16_t ms) {
+  if (host_wait_enabled) {
+    host_advance_ms(ms);
+  }
+}
+
+// Modifiers
+
+uint8_t get_mods(void) {
+  return real_mods;
+}
+
+void add_mods(uint8_t mods) {
+  real_mods |= mods;
+}
+
+void del_mods(uint8_t mods) {
+  real_mods &= ~mods;
+}
+
+void set_mods(uint8_t mods) {
+  real_mods = mods;
+}
+
+void clear_mods(void) {
+  real_mods = 0;
+}
+
+uint8_t get_weak_mods(void) {
+  return weak_mods;
+}
+
+void add_weak_mods(uint8_t mods) {
+  weak_mods |= mods;
+}
+
+void del_weak_mods(uint8_t mods) {
+  weak_mods &= ~mods;
+}
+
+void set_weak_mods(uint8_t mods) {
+  weak_mods = mods;
+}
+
+void clear_weak_mods(void) {
+  weak_mods = 0;
+}
+
+// Reports
+
+static host_report_t *log_report(host_report_type_t type) {
+  static host_report_t discarded;
+  host_report_t       *report = host_report_count < HOST_REPORT_LOG_SIZE ? &host_reports[host_report_count] : &discarded;
+
+  host_report_count++;
+  memset(report, 0, sizeof(*report));
+  report->time_us = host_time_us;
+  report->type    = type;
+  return report;
+}
+
+// 6KRO: a key goes in the first free slot and keeps it until released.
+void add_key(uint8_t code) {
+  for (uint8_t i = 0; i < sizeof(report_keys); i++) {
+    if (report_keys[i] == code) {
+      return;
+    }
+  }
+  for (uint8_t i = 0; i < sizeof(report_keys); i++) {
+    if (report_keys[i] == KC_NO) {
+      report_keys[i] = code;
+      return;
+    }
+  }
+}
+
+void del_key(uint8_t code) {
+  for (uint8_t i = 0; i < sizeof(report_keys); i++) {
+    if (report_keys[i] == code) {
+      report_keys[i] = KC_NO;
+    }
+  }
+}
+
+void send_keyboard_report(void) {
+  host_report_t *report = log_report(HOST_KEYBOARD);
+
+  report->mods = real_mods | weak_mods;
+  memcpy(report->keys, report_keys, sizeof(report_keys));
+}
+
+void host_consumer_send(uint16_t usage) {
+  log_report(HOST_CONSUMER)->usage = usage;
+}
+
+void host_system_send(uint16_t usage) {
+  log_report(HOST_SYSTEM)->usage = usage;
+}
+
+static uint16_t consumer_usage(uint8_t code) {
+  switch (code) {
+    case KC_MUTE: return 0x00E2;
+    case KC_VOLU: return 0x00E9;
+    case KC_VOLD: return 0x00EA;
+    case KC_MNXT: return 0x00B5;
+    case KC_MPRV: return 0x00B6;
+    case KC_MSTP: return 0x00B7;
+    case KC_MPLY: return 0x00CD;
+    case KC_BRIU: return 0x006F;
+    case KC_BRID: return 0x0070;
+    default:      return 0;
+  }
+}
+
+void register_code(uint8_t code) {
+  if (IS_KEY(code)) {
+    add_key(code);
+    send_keyboard_report();
+  } else if (IS_MOD(code)) {
+    add_mods(MOD_BIT(code));
+    send_keyboard_report();
+  } else if (IS_SYSTEM(code)) {
+    host_system_send(0x0081 + code - KC_PWR);
+  } else if (IS_CONSUMER(code)) {
+    host_consumer_send(consumer_usage(code));
+  }
+}
+
+void unregister_code(uint8_t code) {
+  if (IS_KEY(code)) {
+    del_key(code);
+    send_keyboard_report();
+  } else if (IS_MOD(code)) {
+    del_mods(MOD_BIT(code));
+    send_keyboard_report();
+  } else if (IS_SYSTEM(code)) {
+    host_system_send(0);
+  } else if (IS_CONSUMER(code)) {
+    host_consumer_send(0);
+  }
+}
+
+void tap_code(uint8_t code) {
+  register_code(code);
+  unregister_code(code);
+}
+
+// Only basic keycodes reach these here, so there are no mods to unpack.
+void register_code16(uint16_t code) {
+  register_code(code);
+}
+
+void unregister_code16(uint16_t code) {
+  unregister_code(code);
+}
+
+void register_mods(uint8_t mods) {
+  if (mods) {
+    add_mods(mods);
+    send_keyboard_report();
+  }
+}
+
+void unregister_mods(uint8_t mods) {
+  if (mods) {
+    del_mods(mods);
+    send_keyboard_report();
+  }
+}
+
+bool host_report_has_key(const host_report_t *report, uint8_t code) {
+  for (uint8_t i = 0; i < sizeof(report->keys); i++) {
+    if (report->keys[i] == code) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const host_report_t *host_last_report(void) {
+  if (host_report_count == 0) {
+    return NULL;
+  }
+  return &host_reports[(host_report_count < HOST_REPORT_LOG_SIZE ? host_report_count : HOST_REPORT_LOG_SIZE) - 1];
+}
+
+void host_print_new_reports(FILE *out) {
+  for (; printed_reports < host_report_count && printed_reports < HOST_REPORT_LOG_SIZE; printed_reports++) {
+    fprintf(out, "  ");
+    host_print_report(out, &host_reports[printed_reports]);
+  }
+}
+
+void host_print_report(FILE *out, const host_report_t *report) {
+  fprintf(out, "%10.3f ms  ", report->time_us / 1000.0);
+
+  switch (report->type) {
+    case HOST_KEYBOARD:
+      fprintf(out, "keyboard  mods %02X  keys", report->mods);
+      for (uint8_t i = 0; i < sizeof(report->keys); i++) {
+        if (report->keys[i] != KC_NO) {
+          fprintf(out, " %02X", report->keys[i]);
+        }
+      }
+      break;
+    case HOST_CONSUMER:
+      fprintf(out, "consumer  %04X", report->usage);
+      break;
+    case HOST_SYSTEM:
+      fprintf(out, "system    %04X", report->usage);
+      break;
+  }
+  fputc('\n', out);
+}
+
+// Layers
+
+void layer_state_set(layer_state_t state) {
+  layer_state = layer_state_set_user(state);
+}
+
+void layer_move(uint8_t layer) {
+  layer_state_set((layer_state_t)1 << layer);
+}
+
+void layer_on(uint8_t layer) {
+  layer_state_set(layer_state | (layer_state_t)1 << layer);
+}
+
+void layer_off(uint8_t layer) {
+  layer_state_set(layer_state & ~((layer_state_t)1 << layer));
+}
+
+uint8_t get_highest_layer(layer_state_t state) {
+  return state ? 31 - __builtin_clz(state) : 0;
+}
+
+// RGB. Only enough of RGB matrix to see what the keymap asked it to do. The
+// steps are QMK's defaults.
+
+#define HUE_STEP 8
+#define SAT_STEP 16
+#define VAL_STEP 16
+#define SPD_STEP 16
+
+static const host_rgb_config_t rgb_config_default = {
+  .enable = true, .mode = 1, .hue = 0, .sat = 255, .val = 255, .speed = 127,
+};
+
+static uint8_t add_clamped(uint8_t value, int16_t step) {
+  int16_t sum = value + step;
+  return sum < 0 ? 0 : sum > 255 ? 255 : sum;
+}
+
+void rgblight_disable_noeeprom(void) {
+  host_rgb_config.enable = false;
+}
+
+bool rgb_matrix_is_enabled(void) {
+  return host_rgb_config.enable;
+}
+
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+  host_leds[index][0] = red;
+  host_leds[index][1] = green;
+  host_leds[index][2] = blue;
+  host_led_writes++;
+  host_time_us += host_led_write_us;
+}
+
+void rgb_matrix_toggle_noeeprom(void) {
+  host_rgb_config.enable = !host_rgb_config.enable;
+}
+
+void rgb_matrix_step_noeeprom(void) {
+  host_rgb_config.mode = host_rgb_config.mode % (HOST_RGB_MODES - 1) + 1;
+}
+
+void rgb_matrix_step_reverse_noeeprom(void) {
+  host_rgb_config.mode = host_rgb_config.mode > 1 ? host_rgb_config.mode - 1 : HOST_RGB_MODES - 1;
+}
+
+void rgb_matrix_increase_hue_noeeprom(void) {
+  host_rgb_config.hue += HUE_STEP;
+}
+
+void rgb_matrix_decrease_hue_noeeprom(void) {
+  host_rgb_config.hue -= HUE_STEP;
+}
+
+void rgb_matrix_increase_sat_noeeprom(void) {
+  host_rgb_config.sat = add_clamped(host_rgb_config.sat, SAT_STEP);
+}
+
+void rgb_matrix_decrease_sat_noeeprom(void) {
+  host_rgb_config.sat = add_clamped(host_rgb_config.sat, -SAT_STEP);
+}
+
+void rgb_matrix_increase_val_noeeprom(void) {
+  host_rgb_config.val = add_clamped(host_rgb_config.val, VAL_STEP);
+}
+
+void rgb_matrix_decrease_val_noeeprom(void) {
+  host_rgb_config.val = add_clamped(host_rgb_config.val, -VAL_STEP);
+}
+
+void rgb_matrix_increase_speed_noeeprom(void) {
+  host_rgb_config.speed = add_clamped(host_rgb_config.speed, SPD_STEP);
+}
+
+void rgb_matrix_decrease_speed_noeeprom(void) {
+  host_rgb_config.speed = add_clamped(host_rgb_config.speed, -SPD_STEP);
+}
+
+void eeconfig_update_rgb_matrix(void) {
+  const uint8_t *from = (const uint8_t *)&host_rgb_config;
+  uint8_t       *to   = (uint8_t *)&host_eeprom_rgb_config;
+
+  for (size_t i = 0; i < sizeof(host_rgb_config); i++) {
+    if (to[i] != from[i]) {
+      to[i] = from[i];
+      host_eeprom_bytes_written++;
+    }
+  }
+  host_eeprom_writes++;
+}
+
+// Console and bootloader
+
+int uprintf(const char *format, ...) {
+  va_list args;
+  int     length;
+
+  va_start(args, format);
+  length = vsnprintf(&host_console[host_console_length], sizeof(host_console) - host_console_length, format, args);
+  va_end(args);
+
+  if (length > 0) {
+    host_console_length += length;
+    if (host_console_length >= sizeof(host_console)) {
+      host_console_length = sizeof(host_console) - 1;
+    }
+  }
+  return length;
+}
+
+void reset_keyboard(void) {
+  host_bootloader_jumps++;
+}
+
+// Hooks the keymap doesn't define
+
+__attribute__((weak)) void matrix_init_user(void) {}
+__attribute__((weak)) void matrix_scan_user(void) {}
+__attribute__((weak)) void keyboard_post_init_user(void) {}
+__attribute__((weak)) void housekeeping_task_user(void) {}
+__attribute__((weak)) void suspend_power_down_user(void) {}
+
+__attribute__((weak)) layer_state_t layer_state_set_user(layer_state_t state) {
+  return state;
+}
+
+__attribute__((weak)) bool dip_switch_update_user(uint8_t index, bool active) {
+  return true;
+}
+
+// Power-on
+
+// LAYOUT_65_ansi argument index + 1 for every matrix position, 0 for holes.
+static const uint8_t layout_indices[MATRIX_ROWS][MATRIX_COLS] = LAYOUT_65_ansi(
+   1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+  16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30,
+  31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42,     43, 44,
+  45,     46, 47, 48, 49, 50, 51, 52, 53, 54, 55,     56, 57, 58,
+  59, 60, 61,             62,             63, 64, 65, 66, 67, 68
+);
+
+keypos_t host_position(uint8_t position) {
+  for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+      if (layout_indices[row][col] == position) {
+        return (keypos_t){ .col = col, .row = row };
+      }
+    }
+  }
+
+  fprintf(stderr, "host_position: no key at layout position %u\n", position);
+  return (keypos_t){ .col = 0xFF, .row = 0xFF };
+}
+
+void host_reset(void) {
+  host_eeprom_rgb_config = rgb_config_default;
+  host_power_cycle();
+}
+
+void host_power_cycle(void) {
+  real_mods = 0;
+  weak_mods = 0;
+  memset(report_keys, 0, sizeof(report_keys));
+
+  host_report_count         = 0;
+  printed_reports           = 0;
+  host_eeprom_writes        = 0;
+  host_eeprom_bytes_written = 0;
+  host_bootloader_jumps     = 0;
+  host_led_writes           = 0;
+  host_console_length       = 0;
+  host_console[0]           = '\0';
+  host_rgb_config           = host_eeprom_rgb_config;
+  memset(host_leds, 0, sizeof(host_leds));
+
+  for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+      uint8_t index = layout_indices[row][col];
+      g_led_config.matrix_co[row][col] = index ? index - 1 : NO_LED;
+    }
+  }
+
+  // QMK's keyboard_init(): default layer 0 from EEPROM, then the init hooks,
+  // with the dip switches read in between.
+  default_layer_state = 1;
+  layer_state         = 0;
+
+  matrix_init_user();
+  dip_switch_update_user(0, host_dip_switch_mac);
+  keyboard_post_init_user();
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+// Stand-in for the parts of QMK the keymap uses, so keymap.c builds and runs
+// on the host without the SonixQMK tree. Basic, modifier and consumer
+// keycodes have QMK's values; the quantum keycodes only keep QMK's ordering.
+// The behaviour behind it lives in qmk.c and action.c.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// keychron/k6/rgb/ansi config.h
+#define MATRIX_ROWS      5
+#define MATRIX_COLS      16
+#define DRIVER_LED_TOTAL 68
+
+#ifndef DEBOUNCE
+#  define DEBOUNCE 5
+#endif
+
+// Flash is ordinary memory on ARM, same as on the host.
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+
+typedef uint16_t matrix_row_t;
+typedef uint32_t layer_state_t;
+
+typedef struct {
+  uint8_t col;
+  uint8_t row;
+} keypos_t;
+
+typedef struct {
+  keypos_t key;
+  bool     pressed;
+  uint16_t time;
+} keyevent_t;
+
+typedef struct {
+  keyevent_t event;
+} keyrecord_t;
+
+// Keycodes
+
+enum hid_keyboard_keycodes {
+  KC_NO = 0x00,
+  KC_TRNS,
+  KC_A = 0x04, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M,
+  KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z,
+  KC_1, KC_2, KC_3, KC_4, KC_5, KC_6, KC_7, KC_8, KC_9, KC_0,
+  KC_ENT, KC_ESC, KC_BSPC, KC_TAB, KC_SPC, KC_MINS, KC_EQL, KC_LBRC, KC_RBRC, KC_BSLASH,
+  KC_NUHS, KC_SCLN, KC_QUOT, KC_GRV, KC_COMM, KC_DOT, KC_SLSH, KC_CAPS,
+  KC_F1, KC_F2, KC_F3, KC_F4, KC_F5, KC_F6, KC_F7, KC_F8, KC_F9, KC_F10, KC_F11, KC_F12,
+  KC_PSCR, KC_SLCK, KC_PAUS, KC_INS, KC_HOME, KC_PGUP, KC_DEL, KC_END, KC_PGDOWN,
+  KC_RGHT, KC_LEFT, KC_DOWN, KC_UP,
+  KC_F13 = 0x68, KC_F14, KC_F15, KC_F16, KC_F17, KC_F18, KC_F19, KC_F20, KC_F21, KC_F22, KC_F23, KC_F24,
+  KC_EXSEL = 0xA4,
+
+  KC_PWR = 0xA5, KC_SLEP, KC_WAKE,
+  KC_MUTE = 0xA8, KC_VOLU, KC_VOLD, KC_MNXT, KC_MPRV, KC_MSTP, KC_MPLY,
+  KC_BRIU = 0xBD, KC_BRID,
+
+  KC_LCTL = 0xE0, KC_LSFT, KC_LALT, KC_LGUI, KC_RCTL, KC_RSFT, KC_RALT, KC_RGUI,
+};
+
+#define KC_BSLS   KC_BSLASH
+#define KC_PGDN   KC_PGDOWN
+#define KC_RCTRL  KC_RCTL
+#define KC_LCTRL  KC_LCTL
+#define _______   KC_TRNS
+#define XXXXXXX   KC_NO
+
+#define IS_KEY(code)      ((code) >= KC_A && (code) <= KC_EXSEL)
+#define IS_SYSTEM(code)   ((code) >= KC_PWR && (code) <= KC_WAKE)
+#define IS_CONSUMER(code) ((code) >= KC_MUTE && (code) <= KC_BRID)
+#define IS_MOD(code)      ((code) >= KC_LCTL && (code) <= KC_RGUI)
+
+#define QK_MOMENTARY     0x5100
+#define QK_MOMENTARY_MAX 0x51FF
+#define MO(layer)        (QK_MOMENTARY | ((layer) & 0xFF))
+
+enum quantum_keycodes {
+  RESET = 0x5C00,
+  RGB_TOG = 0x5CC2,
+  RGB_MOD,
+  RGB_RMOD,
+  RGB_HUI,
+  RGB_HUD,
+  RGB_SAI,
+  RGB_SAD,
+  RGB_VAI,
+  RGB_VAD,
+  RGB_SPI,
+  RGB_SPD,
+  SAFE_RANGE = 0x5DA0,
+};
+
+// Modifiers
+
+#define MOD_BIT(code)  (1 << ((code) & 0x07))
+#define MOD_MASK_CTRL  (MOD_BIT(KC_LCTL) | MOD_BIT(KC_RCTL))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+#define MOD_MASK_ALT   (MOD_BIT(KC_LALT) | MOD_BIT(KC_RALT))
+#define MOD_MASK_GUI   (MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI))
+
+uint8_t get_mods(void);
+void    add_mods(uint8_t mods);
+void    del_mods(uint8_t mods);
+void    set_mods(uint8_t mods);
+void    clear_mods(void);
+uint8_t get_weak_mods(void);
+void    add_weak_mods(uint8_t mods);
+void    del_weak_mods(uint8_t mods);
+void    set_weak_mods(uint8_t mods);
+void    clear_weak_mods(void);
+
+// Reports
+
+void add_key(uint8_t code);
+void del_key(uint8_t code);
+void send_keyboard_report(void);
+void host_consumer_send(uint16_t usage);
+void host_system_send(uint16_t usage);
+void register_code(uint8_t code);
+void unregister_code(uint8_t code);
+void tap_code(uint8_t code);
+void register_code16(uint16_t code);
+void unregister_code16(uint16_t code);
+void register_mods(uint8_t mods);
+void unregister_mods(uint8_t mods);
+
+// Layers
+
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+
+void    layer_state_set(layer_state_t state);
+void    layer_move(uint8_t layer);
+void    layer_on(uint8_t layer);
+void    layer_off(uint8_t layer);
+uint8_t get_highest_layer(layer_state_t state);
+
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
+
+// Timers
+
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+#define TIMER_DIFF_32(a, b) ((uint32_t)((a) - (b)))
+
+void wait_ms(uint16_t ms);
+
+// RGB
+
+#define NO_LED 255
+
+typedef struct {
+  uint8_t matrix_co[MATRIX_ROWS][MATRIX_COLS];
+} led_config_t;
+
+extern led_config_t g_led_config;
+
+void rgblight_disable_noeeprom(void);
+bool rgb_matrix_is_enabled(void);
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
+void rgb_matrix_toggle_noeeprom(void);
+void rgb_matrix_step_noeeprom(void);
+void rgb_matrix_step_reverse_noeeprom(void);
+void rgb_matrix_increase_hue_noeeprom(void);
+void rgb_matrix_decrease_hue_noeeprom(void);
+void rgb_matrix_increase_sat_noeeprom(void);
+void rgb_matrix_decrease_sat_noeeprom(void);
+void rgb_matrix_increase_val_noeeprom(void);
+void rgb_matrix_decrease_val_noeeprom(void);
+void rgb_matrix_increase_speed_noeeprom(void);
+void rgb_matrix_decrease_speed_noeeprom(void);
+void eeconfig_update_rgb_matrix(void);
+
+// Console and bootloader
+
+extern bool debug_enable;
+extern bool debug_matrix;
+extern bool debug_keyboard;
+extern bool debug_mouse;
+
+int  uprintf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+void reset_keyboard(void);
+
+// Hooks the keymap may define
+
+void          matrix_init_user(void);
+void          matrix_scan_user(void);
+void          keyboard_post_init_user(void);
+void          housekeeping_task_user(void);
+void          suspend_power_down_user(void);
+bool          process_record_user(uint16_t keycode, keyrecord_t *record);
+void          post_process_record_user(uint16_t keycode, keyrecord_t *record);
+layer_state_t layer_state_set_user(layer_state_t state);
+bool          dip_switch_update_user(uint8_t index, bool active);
@@ -0,0 +1,69 @@
+#include <stdlib.h>
+#include <string.h>
+#include "host.h"
+#include "trace_file.h"
+
+// Replays a key event trace saved with scripts/key-trace.py -o through the
+// host build of keymap.c, and prints each event followed by the reports it
+// sent. make diffs the output against the goldens in data/.
+//
+//   replay_trace [-w] trace.k6t
+//
+// -w replays on the Windows layers; the trace doesn't record the dip switch.
+// The trace holds the modifiers keymap.c saw before each event, so an event
+// whose modifiers differ on replay is marked, which is where a replay stops
+// telling the story of the recording.
+
+int main(int argc, char **argv) {
+  bool windows = argc == 3 && strcmp(argv[1], "-w") == 0;
+
+  if (argc != 2 + windows) {
+    fprintf(stderr, "usage: replay_trace [-w] trace.k6t\n");
+    return 2;
+  }
+
+  uint16_t count;
+  uint8_t *trace = trace_file_read(argv[argc - 1], &count);
+
+  if (!trace) {
+    return 1;
+  }
+
+  host_dip_switch_mac = !windows;
+  host_reset();
+
+  // Leave the init hooks' housekeeping behind before the first event.
+  uint32_t time_ms = 1;
+
+  for (uint16_t i = 0; i < count; i++) {
+    const uint8_t *event   = &trace[TRACE_HEADER_BYTES + i * TRACE_EVENT_BYTES];
+    uint16_t       delta   = event[0] | event[1] << 8;
+    uint8_t        key     = event[2];
+    uint8_t        mods    = event[3];
+    bool           pressed = key & 0x80;
+
+    // The oldest event's delta points at one that was overwritten.
+    time_ms += i ? delta : 0;
+    host_idle_until(time_ms * 1000);
+
+    // Anything the housekeeping task sent while waiting, such as a held
+    // Esc/Ctrl turning into Ctrl.
+    host_print_new_reports(stdout);
+
+    printf("%10.3f ms  r%u c%-2u %s", host_time_us / 1000.0, (key >> 4) & 0x7, key & 0xF, pressed ? "down" : "up");
+    if (get_mods() != mods) {
+      printf("%s  mods %02X, traced %02X", pressed ? "" : "  ", get_mods(), mods);
+    }
+    putchar('\n');
+
+    host_key((keypos_t){ .row = (key >> 4) & 0x7, .col = key & 0xF }, pressed);
+    host_print_new_reports(stdout);
+  }
+
+  // And whatever the last event left to run out.
+  host_idle_ms(1000);
+  host_print_new_reports(stdout);
+
+  free(trace);
+  return 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Minimal checks for the host tests. A failed check prints where it failed
+// and the test carries on; test_result() turns the tally into an exit code.
+
+#include <stdio.h>
+
+static int test_checks;
+static int test_failures;
+
+#define CHECK(condition)                                                        \
+  do {                                                                          \
+    test_checks++;                                                              \
+    if (!(condition)) {                                                         \
+      test_failures++;                                                          \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+    }                                                                           \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                              \
+  do {                                                                          \
+    long long actual_   = (long long)(actual);                                  \
+    long long expected_ = (long long)(expected);                                \
+    test_checks++;                                                              \
+    if (actual_ != expected_) {                                                 \
+      test_failures++;                                                          \
+      fprintf(stderr, "%s:%d: %s is %lld (0x%llX), expected %lld (0x%llX)\n",   \
+              __FILE__, __LINE__, #actual, actual_, actual_, expected_, expected_); \
+    }                                                                           \
+  } while (0)
+
+static inline int test_result(const char *name) {
+  if (test_failures) {
+    fprintf(stderr, "%s: %d of %d checks failed\n", name, test_failures, test_checks);
+    return 1;
+  }
+
+  printf("%s: %d checks passed\n", name, test_checks);
+  return 0;
+}
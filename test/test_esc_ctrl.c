@@ -0,0 +1,220 @@
+#include "esc_ctrl.h"
+#include "host.h"
+#include "sparse_keymap.h"
+#include "test.h"
+
+// Timing of the Caps Lock position, Esc on tap and Ctrl on hold. Each case
+// is swept over every hold or overlap time in ms, and the worst delay it
+// adds to what reaches the host is printed:
+//
+// - tap: Esc goes out on release, so it is as late as the key was held.
+// - solo hold: Ctrl goes out ESC_CTRL_TAP_TERM ms after the press, even
+//   when the release comes in before the task has seen the term run out.
+// - chord: Ctrl goes out at the other key's press, in a report just ahead
+//   of that key's, so neither is delayed.
+// - layer chord: the other key is FN1, which sends nothing itself, and Ctrl
+//   still goes out at its press.
+// - rollover: the other key goes down before Esc/Ctrl comes up. That is a
+//   chord as far as the keymap can tell, so it sends Ctrl and that key, not
+//   Esc, and again delays nothing.
+// - Esc then another key without overlap: Esc on release, the key on time.
+
+#define SWEEP_MS (ESC_CTRL_TAP_TERM * 2)
+
+static uint32_t reports_before;
+static uint32_t start_us;
+
+static void start(void) {
+  host_reset();
+  host_idle_ms(1);
+  start_us       = host_time_us;
+  reports_before = host_report_count;
+}
+
+static void wait_until_ms(uint32_t ms) {
+  host_idle_until(start_us + ms * 1000);
+}
+
+static uint32_t new_reports(void) {
+  return host_report_count - reports_before;
+}
+
+static const host_report_t *new_report(uint32_t index) {
+  return &host_reports[reports_before + index];
+}
+
+static uint32_t ms_since_start(const host_report_t *report) {
+  return (report->time_us - start_us) / 1000;
+}
+
+// The most each case delays a report past the press that caused it, in ms.
+static uint32_t worst_tap_ms;
+static uint32_t worst_hold_ms;
+static uint32_t worst_chord_ms;
+static uint32_t worst_layer_chord_ms;
+static uint32_t worst_rollover_ms;
+static uint32_t worst_sequence_ms;
+
+static uint32_t max_ms(uint32_t a, uint32_t b) {
+  return a > b ? a : b;
+}
+
+// Esc/Ctrl alone, held for hold ms.
+static void test_solo(void) {
+  for (uint32_t hold = 0; hold <= SWEEP_MS; hold++) {
+    start();
+    host_press(POS_CAPS);
+    wait_until_ms(hold);
+    host_release(POS_CAPS);
+    wait_until_ms(SWEEP_MS + 10);
+
+    if (hold < ESC_CTRL_TAP_TERM) {
+      // Esc down and up, together on release.
+      CHECK_EQ(new_reports(), 2);
+      CHECK(host_report_has_key(new_report(0), KC_ESC));
+      CHECK_EQ(new_report(0)->mods, 0);
+      CHECK(!host_report_has_key(new_report(1), KC_ESC));
+      CHECK_EQ(ms_since_start(new_report(0)), hold);
+      worst_tap_ms = max_ms(worst_tap_ms, ms_since_start(new_report(0)));
+    } else {
+      // Ctrl at the tap term, then up again on release. No Esc.
+      CHECK_EQ(new_reports(), 2);
+      CHECK_EQ(new_report(0)->mods, MOD_BIT(KC_LCTL));
+      CHECK(!host_report_has_key(new_report(0), KC_ESC));
+      CHECK_EQ(new_report(1)->mods, 0);
+      CHECK_EQ(ms_since_start(new_report(0)), ESC_CTRL_TAP_TERM);
+      worst_hold_ms = max_ms(worst_hold_ms, ms_since_start(new_report(0)));
+    }
+  }
+}
+
+// Esc/Ctrl held, A tapped after delay ms, then Esc/Ctrl released.
+static void test_chord(void) {
+  for (uint32_t delay = 0; delay <= SWEEP_MS; delay++) {
+    start();
+    host_press(POS_CAPS);
+    wait_until_ms(delay);
+
+    uint32_t before = new_reports();
+
+    host_press(POS_A);
+
+    // Ctrl-A at A's press, whether or not the tap term has already made it
+    // Ctrl.
+    CHECK(new_reports() > before);
+    CHECK_EQ(new_report(new_reports() - 1)->mods, MOD_BIT(KC_LCTL));
+    CHECK(host_report_has_key(new_report(new_reports() - 1), KC_A));
+    for (uint32_t i = 0; i < new_reports(); i++) {
+      CHECK(!host_report_has_key(new_report(i), KC_ESC));
+    }
+    worst_chord_ms = max_ms(worst_chord_ms, ms_since_start(new_report(new_reports() - 1)) - delay);
+
+    wait_until_ms(delay + 30);
+    host_release(POS_A);
+    host_release(POS_CAPS);
+    CHECK_EQ(new_report(new_reports() - 1)->mods, 0);
+  }
+}
+
+// Esc/Ctrl held, FN1 pressed after delay ms. FN1 only changes the layer,
+// so the report carrying Ctrl is the one Esc/Ctrl sends itself: at FN1's
+// press, or at the tap term if that came first.
+static void test_layer_chord(void) {
+  for (uint32_t delay = 0; delay <= SWEEP_MS; delay++) {
+    start();
+    host_press(POS_CAPS);
+    wait_until_ms(delay);
+    host_press(POS_FN1);
+
+    CHECK_EQ(new_reports(), 1);
+    CHECK_EQ(new_report(0)->mods, MOD_BIT(KC_LCTL));
+    if (delay < ESC_CTRL_TAP_TERM) {
+      CHECK_EQ(ms_since_start(new_report(0)), delay);
+      worst_layer_chord_ms = max_ms(worst_layer_chord_ms, ms_since_start(new_report(0)) - delay);
+    } else {
+      CHECK_EQ(ms_since_start(new_report(0)), ESC_CTRL_TAP_TERM);
+    }
+
+    wait_until_ms(delay + 30);
+    host_release(POS_FN1);
+    host_release(POS_CAPS);
+    CHECK_EQ(new_reports(), 2);
+    CHECK_EQ(new_report(1)->mods, 0);
+    for (uint32_t i = 0; i < new_reports(); i++) {
+      CHECK(!host_report_has_key(new_report(i), KC_ESC));
+    }
+  }
+}
+
+// Fast rollover: Esc/Ctrl down, A down after delay ms, Esc/Ctrl up after
+// overlap ms more, then A up. A is never held back and goes out with Ctrl.
+static void test_rollover(void) {
+  for (uint32_t delay = 0; delay < ESC_CTRL_TAP_TERM; delay += 5) {
+    for (uint32_t overlap = 1; overlap <= 60; overlap += 3) {
+      start();
+      host_press(POS_CAPS);
+      wait_until_ms(delay);
+      host_press(POS_A);
+
+      const host_report_t *a = new_report(new_reports() - 1);
+
+      CHECK_EQ(new_reports(), 2);
+      CHECK_EQ(new_report(0)->mods, MOD_BIT(KC_LCTL));
+      CHECK_EQ(a->mods, MOD_BIT(KC_LCTL));
+      CHECK(host_report_has_key(a, KC_A));
+      worst_rollover_ms = max_ms(worst_rollover_ms, ms_since_start(a) - delay);
+
+      wait_until_ms(delay + overlap);
+      host_release(POS_CAPS);
+      CHECK_EQ(new_report(new_reports() - 1)->mods, 0);
+      CHECK(host_report_has_key(new_report(new_reports() - 1), KC_A));
+
+      wait_until_ms(delay + overlap + 20);
+      host_release(POS_A);
+      for (uint32_t i = 0; i < new_reports(); i++) {
+        CHECK(!host_report_has_key(new_report(i), KC_ESC));
+      }
+    }
+  }
+}
+
+// Esc tapped, then A pressed gap ms after its release.
+static void test_sequence(void) {
+  for (uint32_t gap = 0; gap <= 60; gap++) {
+    start();
+    host_press(POS_CAPS);
+    wait_until_ms(40);
+    host_release(POS_CAPS);
+    wait_until_ms(40 + gap);
+    host_press(POS_A);
+
+    CHECK_EQ(new_reports(), 3);
+    CHECK(host_report_has_key(new_report(0), KC_ESC));
+    CHECK_EQ(new_report(2)->mods, 0);
+    CHECK(host_report_has_key(new_report(2), KC_A));
+    worst_sequence_ms = max_ms(worst_sequence_ms, ms_since_start(new_report(2)) - (40 + gap));
+
+    host_release(POS_A);
+  }
+}
+
+int main(void) {
+  test_solo();
+  test_chord();
+  test_layer_chord();
+  test_rollover();
+  test_sequence();
+
+  CHECK_EQ(worst_tap_ms, ESC_CTRL_TAP_TERM - 1);
+  CHECK_EQ(worst_hold_ms, ESC_CTRL_TAP_TERM);
+  CHECK_EQ(worst_chord_ms, 0);
+  CHECK_EQ(worst_layer_chord_ms, 0);
+  CHECK_EQ(worst_rollover_ms, 0);
+  CHECK_EQ(worst_sequence_ms, 0);
+
+  printf("test_esc_ctrl: worst added ms: tap %u (Esc on release), solo hold %u (Ctrl at the tap term), "
+         "chord %u, layer chord %u, rollover %u, Esc then key %u\n",
+         worst_tap_ms, worst_hold_ms, worst_chord_ms, worst_layer_chord_ms, worst_rollover_ms, worst_sequence_ms);
+
+  return test_result("test_esc_ctrl");
+}
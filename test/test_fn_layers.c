@@ -0,0 +1,102 @@
+// keymap.c is included rather than linked so the test can see which layers
+// the build has, and its FN layer overlays.
+#define K6_FN_LAYER_OVERLAYS
+#include "keymap.c"
+#include "host.h"
+#include "sparse_keymap.h"
+#include "test.h"
+
+// Holds every reachable combination of FN keys on each OS and checks the
+// keycode of every key, as read from the generated layers in fn_layers.inc,
+// against a QMK layer walk over the overlays in keymap.c. Those are what
+// scripts/gen-fn-layers.py generates the layers from.
+
+#ifndef TEST_NAME
+#  define TEST_NAME "test_fn_layers"
+#endif
+
+typedef struct {
+  uint8_t base;
+  uint8_t fn1;
+  uint8_t fn2;
+} os_layers_t;
+
+static const os_layers_t os_layers[] = {
+#ifdef K6_MAC_LAYERS
+  {_MAC_BASE, _MAC_FN1, _MAC_FN2},
+#endif
+#ifdef K6_WIN_LAYERS
+  {_WIN_BASE, _WIN_FN1, _WIN_FN2},
+#endif
+};
+
+// An overlay's key at position; anything not listed is KC_NO.
+static uint16_t overlay_keycode(uint8_t layer, uint8_t position) {
+  const sparse_layer_t *overlay = &fn_layers[layer - FN_LAYERS_START].overlay;
+
+  for (uint8_t i = 0; i < overlay->count; i++) {
+    if (overlay->keys[i].position == position) {
+      return overlay->keys[i].keycode;
+    }
+  }
+  return KC_NO;
+}
+
+// What QMK's layer walk gives over the overlays: the highest held layer
+// where the key isn't KC_TRNS.
+static uint16_t reference_keycode(const os_layers_t *os, bool fn1, bool fn2, uint8_t position) {
+  if (fn2 && overlay_keycode(os->fn2, position) != KC_TRNS) {
+    return overlay_keycode(os->fn2, position);
+  }
+  if (fn1 && overlay_keycode(os->fn1, position) != KC_TRNS) {
+    return overlay_keycode(os->fn1, position);
+  }
+
+  keypos_t key = host_position(position);
+  return keymaps[os->base][key.row][key.col];
+}
+
+static void test_layer_states(const os_layers_t *os) {
+  // KC_TRNS on an FN layer falls through to its own OS's base layer.
+  CHECK_EQ(fn_layers[os->fn1 - FN_LAYERS_START].base, os->base);
+  CHECK_EQ(fn_layers[os->fn2 - FN_LAYERS_START].base, os->base);
+
+  for (uint8_t held = 0; held < 4; held++) {
+    bool          fn1   = held & 1;
+    bool          fn2   = held & 2;
+    layer_state_t state = (layer_state_t)1 << os->base;
+
+    // The dip switch moves to the OS's base layer and MO() adds FN layers on
+    // top, with the default layer left at layer 0.
+    state |= fn1 ? (layer_state_t)1 << os->fn1 : 0;
+    state |= fn2 ? (layer_state_t)1 << os->fn2 : 0;
+    layer_state_set(state);
+
+    for (uint8_t position = POS_ESC; position <= POS_RGHT; position++) {
+      keypos_t key = host_position(position);
+      uint16_t top = keymap_key_to_keycode(get_highest_layer(layer_state | default_layer_state), key);
+
+      // KC_TRNS is resolved up front, so the walk never goes past the top.
+      CHECK(top != KC_TRNS);
+      CHECK_EQ(host_keycode(key), reference_keycode(os, fn1, fn2, position));
+    }
+  }
+}
+
+int main(void) {
+  host_reset();
+
+  for (uint8_t i = 0; i < sizeof(os_layers) / sizeof(os_layers[0]); i++) {
+    test_layer_states(&os_layers[i]);
+  }
+
+  // The mod overrides are all for MAC_EXPOSE, which only the macOS FN1 layer
+  // has, so a Windows-only build has none.
+#ifdef K6_MAC_LAYERS
+  CHECK(mod_override_count > 0);
+#else
+  CHECK_EQ(mod_override_count, 0);
+#endif
+
+  return test_result(TEST_NAME);
+}
@@ -0,0 +1,85 @@
+#include "host.h"
+#include "sparse_keymap.h"
+#include "test.h"
+
+// Smoke test for the host build: a few keys on each layer come out as the
+// keymap says they should.
+
+static void test_base_layer(void) {
+  host_reset();
+
+  host_press(POS_A);
+  CHECK_EQ(host_report_count, 1);
+  CHECK(host_report_has_key(host_last_report(), KC_A));
+
+  host_release(POS_A);
+  CHECK_EQ(host_report_count, 2);
+  CHECK(!host_report_has_key(host_last_report(), KC_A));
+
+  host_press(POS_LSFT);
+  CHECK_EQ(host_last_report()->mods, MOD_BIT(KC_LSFT));
+  host_release(POS_LSFT);
+  CHECK_EQ(host_last_report()->mods, 0);
+}
+
+static void test_mac_fn_layers(void) {
+  host_dip_switch_mac = true;
+  host_reset();
+
+  host_press(POS_FN1);
+  host_tap(POS_1);
+  CHECK(host_report_has_key(&host_reports[0], KC_F14));
+
+  host_press(POS_0);
+  CHECK_EQ(host_last_report()->type, HOST_CONSUMER);
+  CHECK_EQ(host_last_report()->usage, 0x00E2);
+  host_release(POS_0);
+  CHECK_EQ(host_last_report()->usage, 0);
+
+  host_tap(POS_SPC);
+  CHECK_EQ(host_bootloader_jumps, 1);
+  host_release(POS_FN1);
+
+  host_press(POS_FN2);
+  host_tap(POS_Q);
+  CHECK(host_report_has_key(&host_reports[host_report_count - 2], KC_F13));
+  host_release(POS_FN2);
+
+  // Back on the base layer once FN2 is up.
+  host_tap(POS_ESC);
+  CHECK(host_report_has_key(&host_reports[host_report_count - 2], KC_GRV));
+}
+
+static void test_windows_layers(void) {
+  host_dip_switch_mac = false;
+  host_reset();
+
+  host_tap(POS_ESC);
+  CHECK(host_report_has_key(&host_reports[0], KC_ESC));
+
+  host_press(POS_LALT);
+  CHECK_EQ(host_last_report()->mods, MOD_BIT(KC_LGUI));
+  host_release(POS_LALT);
+
+  host_press(POS_FN1);
+  host_press(POS_1);
+  CHECK_EQ(host_last_report()->type, HOST_CONSUMER);
+  CHECK_EQ(host_last_report()->usage, 0x0070);
+  host_release(POS_1);
+
+  // KC_TRNS on the FN layer falls through to the Windows base layer.
+  host_press(POS_LALT);
+  CHECK_EQ(host_last_report()->mods, MOD_BIT(KC_LGUI));
+  host_release(POS_LALT);
+  host_release(POS_FN1);
+
+  host_dip_switch_mac = true;
+}
+
+int main(void) {
+  test_base_layer();
+  test_mac_fn_layers();
+  test_windows_layers();
+
+  return test_result("test_keymap");
+}
@@ -0,0 +1,84 @@
+#include "latency_histogram.h"
+#include "test.h"
+
+// Bucket edges, percentiles and saturation of the latency histogram.
+
+static latency_histogram_t histogram;
+
+static void test_bucket_edges(void) {
+  // Each bucket's largest value is one below the next bucket's smallest,
+  // and each bucket holds exactly the values up to its max.
+  for (uint8_t bucket = 0; bucket < LATENCY_HISTOGRAM_BUCKETS - 1; bucket++) {
+    uint32_t max = latency_histogram_bucket_max(bucket);
+
+    latency_histogram_reset(&histogram);
+    latency_histogram_add(&histogram, max);
+    CHECK_EQ(histogram.buckets[bucket], 1);
+
+    latency_histogram_reset(&histogram);
+    latency_histogram_add(&histogram, max + 1);
+    CHECK_EQ(histogram.buckets[bucket + 1], 1);
+  }
+
+  CHECK_EQ(latency_histogram_bucket_max(0), 0);
+  CHECK_EQ(latency_histogram_bucket_max(1), 1);
+  CHECK_EQ(latency_histogram_bucket_max(2), 2);
+  CHECK_EQ(latency_histogram_bucket_max(3), 3);
+  CHECK_EQ(latency_histogram_bucket_max(4), 5);
+  CHECK_EQ(latency_histogram_bucket_max(5), 7);
+
+  // Anything past the last edge lands in the last bucket.
+  latency_histogram_reset(&histogram);
+  latency_histogram_add(&histogram, UINT32_MAX);
+  CHECK_EQ(histogram.buckets[LATENCY_HISTOGRAM_BUCKETS - 1], 1);
+}
+
+static void test_summary_values(void) {
+  latency_histogram_reset(&histogram);
+  CHECK_EQ(latency_histogram_average(&histogram), 0);
+  CHECK_EQ(latency_histogram_percentile(&histogram, 99), 0);
+
+  // 99 fast samples and one slow one.
+  for (uint8_t i = 0; i < 99; i++) {
+    latency_histogram_add(&histogram, 100);
+  }
+  latency_histogram_add(&histogram, 10000);
+
+  CHECK_EQ(histogram.count, 100);
+  CHECK_EQ(histogram.min, 100);
+  CHECK_EQ(histogram.max, 10000);
+  CHECK_EQ(latency_histogram_average(&histogram), (99 * 100 + 10000) / 100);
+  // Percentiles are bucket bounds, 100 being in the [96, 127] bucket...
+  CHECK_EQ(latency_histogram_percentile(&histogram, 50), 127);
+  CHECK_EQ(latency_histogram_percentile(&histogram, 99), 127);
+  CHECK_EQ(latency_histogram_percentile(&histogram, 100), 10000);
+
+  // ...clamped to the largest value seen.
+  latency_histogram_reset(&histogram);
+  latency_histogram_add(&histogram, 100);
+  CHECK_EQ(latency_histogram_percentile(&histogram, 99), 100);
+}
+
+static void test_saturation(void) {
+  latency_histogram_reset(&histogram);
+
+  for (uint32_t i = 0; i < 70000; i++) {
+    latency_histogram_add(&histogram, 10);
+  }
+  latency_histogram_add(&histogram, 1000);
+
+  CHECK_EQ(histogram.buckets[6], UINT16_MAX);
+  CHECK_EQ(histogram.count, 70001);
+  // The percentile walks the saturated buckets, not count. 10 is in the
+  // [8, 11] bucket.
+  CHECK_EQ(latency_histogram_percentile(&histogram, 99), 11);
+  CHECK_EQ(latency_histogram_percentile(&histogram, 100), 1000);
+}
+
+int main(void) {
+  test_bucket_edges();
+  test_summary_values();
+  test_saturation();
+
+  return test_result("test_latency_histogram");
+}
@@ -0,0 +1,175 @@
+#include <stdlib.h>
+#include "ch.h"
+#include "host.h"
+#include "latency_stats.h"
+#include "sparse_keymap.h"
+#include "test.h"
+
+// Drives keymap.c built with LATENCY_STATS_ENABLE through main loops on the
+// host clock and checks the summaries it prints: which stages each kind of
+// event is counted in, and the times recorded.
+
+#define CYCLES_PER_US (HOST_CPU_FREQUENCY / 1000000)
+
+typedef struct {
+  uint32_t count;
+  uint32_t min;
+  uint32_t avg;
+  uint32_t p99;
+  uint32_t max;
+} stage_summary_t;
+
+static stage_summary_t summary[LATENCY_STAGE_COUNT];
+
+static uint32_t get_u32(const uint8_t *bytes) {
+  return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+// Makes the next loop send its summary and decodes it into summary[].
+static void read_summary(void) {
+  host_console_length = 0;
+  host_console[0]     = '\0';
+  host_advance_ms(LATENCY_STATS_INTERVAL);
+  housekeeping_task_user();
+
+  const char *line = strstr(host_console, "LAT ");
+  CHECK(line != NULL);
+  if (!line) {
+    return;
+  }
+
+  uint8_t packet[6 + LATENCY_STAGE_COUNT * 20];
+  for (uint8_t i = 0; i < sizeof(packet); i++) {
+    char hex[3] = { line[4 + i * 2], line[5 + i * 2], '\0' };
+    packet[i]   = strtoul(hex, NULL, 16);
+  }
+
+  CHECK_EQ(packet[0], 1);
+  CHECK_EQ(packet[1], LATENCY_STAGE_COUNT);
+  CHECK_EQ(get_u32(&packet[2]), HOST_CPU_FREQUENCY);
+
+  for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    const uint8_t *in = &packet[6 + stage * 20];
+
+    summary[stage] = (stage_summary_t){ get_u32(&in[0]), get_u32(&in[4]), get_u32(&in[8]), get_u32(&in[12]),
+                                        get_u32(&in[16]) };
+  }
+}
+
+// One pass of QMK's main loop: the matrix scan takes scan_us, then QMK
+// spends dispatch_us before each event reaches process_record_user.
+static void loop(uint32_t scan_us, uint32_t dispatch_us, const uint8_t *positions, const bool *pressed, uint8_t count) {
+  host_advance_us(scan_us);
+  matrix_scan_user();
+
+  for (uint8_t i = 0; i < count; i++) {
+    host_advance_us(dispatch_us);
+    host_key(host_position(positions[i]), pressed[i]);
+  }
+
+  housekeeping_task_user();
+}
+
+static void idle_loop(void) {
+  loop(100, 0, NULL, NULL, 0);
+}
+
+static void start(void) {
+  host_reset();
+  host_wait_enabled = false;
+  housekeeping_task_user();
+  read_summary();
+}
+
+static void test_idle_scans_not_counted(void) {
+  start();
+
+  for (uint16_t i = 0; i < 1000; i++) {
+    idle_loop();
+  }
+  read_summary();
+
+  for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    CHECK_EQ(summary[stage].count, 0);
+  }
+}
+
+static void test_event_stages(void) {
+  start();
+
+  for (uint8_t i = 0; i < 10; i++) {
+    idle_loop();
+  }
+  loop(200, 50, (const uint8_t[]){ POS_A }, (const bool[]){ true }, 1);
+  idle_loop();
+  loop(200, 50, (const uint8_t[]){ POS_A }, (const bool[]){ false }, 1);
+  read_summary();
+
+  // Only the two scans that found a change.
+  CHECK_EQ(summary[LATENCY_SCAN].count, 2);
+  CHECK_EQ(summary[LATENCY_SCAN].min, 200 * CYCLES_PER_US);
+  CHECK_EQ(summary[LATENCY_SCAN].max, 200 * CYCLES_PER_US);
+  CHECK_EQ(summary[LATENCY_DISPATCH].count, 2);
+  CHECK_EQ(summary[LATENCY_DISPATCH].max, 50 * CYCLES_PER_US);
+  CHECK_EQ(summary[LATENCY_USER].count, 2);
+  CHECK_EQ(summary[LATENCY_REPORT].count, 2);
+  CHECK_EQ(summary[LATENCY_TOTAL].count, 2);
+  CHECK_EQ(summary[LATENCY_TOTAL].max, 250 * CYCLES_PER_US);
+}
+
+// Esc/Ctrl is handled in the keymap, so it's finished without a report
+// stage.
+static void test_keymap_consumed(void) {
+  start();
+
+  loop(100, 0, (const uint8_t[]){ POS_CAPS }, (const bool[]){ true }, 1);
+  read_summary();
+
+  CHECK_EQ(summary[LATENCY_DISPATCH].count, 1);
+  CHECK_EQ(summary[LATENCY_USER].count, 1);
+  CHECK_EQ(summary[LATENCY_REPORT].count, 0);
+  CHECK_EQ(summary[LATENCY_TOTAL].count, 1);
+
+  loop(100, 0, (const uint8_t[]){ POS_CAPS }, (const bool[]){ false }, 1);
+}
+
+// FN1 + Space is RESET, which QMK's own processing stops after the keymap
+// passed it on, so post_process_record_user never runs for it. A second
+// event in the same scan mustn't have that counted as its dispatch time.
+static void test_quantum_consumed(void) {
+  start();
+
+  loop(100, 0, (const uint8_t[]){ POS_FN1 }, (const bool[]){ true }, 1);
+  read_summary();
+
+  loop(100, 50, (const uint8_t[]){ POS_SPC, POS_A }, (const bool[]){ true, true }, 2);
+  CHECK_EQ(host_bootloader_jumps, 1);
+  read_summary();
+
+  CHECK_EQ(summary[LATENCY_SCAN].count, 1);
+  CHECK_EQ(summary[LATENCY_DISPATCH].count, 1);
+  CHECK_EQ(summary[LATENCY_USER].count, 2);
+  CHECK_EQ(summary[LATENCY_REPORT].count, 1);
+  CHECK_EQ(summary[LATENCY_TOTAL].count, 1);
+  CHECK_EQ(summary[LATENCY_TOTAL].max, 200 * CYCLES_PER_US);
+
+  // A quantum-consumed event on its own in a scan leaves the next loop
+  // clean.
+  loop(100, 50, (const uint8_t[]){ POS_SPC }, (const bool[]){ false }, 1);
+  loop(100, 50, (const uint8_t[]){ POS_SPC }, (const bool[]){ true }, 1);
+  loop(100, 50, (const uint8_t[]){ POS_A }, (const bool[]){ false }, 1);
+  read_summary();
+
+  CHECK_EQ(summary[LATENCY_DISPATCH].count, 3);
+  CHECK_EQ(summary[LATENCY_DISPATCH].max, 50 * CYCLES_PER_US);
+  CHECK_EQ(summary[LATENCY_TOTAL].count, 1);
+}
+
+int main(void) {
+  test_idle_scans_not_counted();
+  test_event_stages();
+  test_keymap_consumed();
+  test_quantum_consumed();
+
+  return test_result("test_latency_stats");
+}
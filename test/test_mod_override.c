@@ -0,0 +1,170 @@
+#include "host.h"
+#include "mod_override.h"
+#include "sparse_keymap.h"
+#include "test.h"
+
+// Presses the trigger of every row in keymap.c's mod_overrides[] with the
+// row's required modifiers held, on whichever layer the trigger is found,
+// and checks what the host gets: one report on press and one on release.
+// Also checks that no row is shadowed by an earlier one.
+
+static const struct {
+  uint8_t mod;
+  uint8_t position;
+} modifier_keys[] = {
+  {MOD_BIT(KC_LCTL), POS_LCTL},
+  {MOD_BIT(KC_LSFT), POS_LSFT},
+  {MOD_BIT(KC_LALT), POS_LALT},
+  {MOD_BIT(KC_LGUI), POS_LGUI},
+  {MOD_BIT(KC_RSFT), POS_RSFT},
+  {MOD_BIT(KC_RGUI), POS_RGUI},
+};
+
+// A physical key that sends one of required, 0 if nothing is required.
+static uint8_t modifier_for(uint8_t required) {
+  for (uint8_t i = 0; i < sizeof(modifier_keys) / sizeof(modifier_keys[0]); i++) {
+    if (required & modifier_keys[i].mod) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+static bool find_on_layer(uint8_t layer, uint16_t keycode, uint8_t *position) {
+  for (uint8_t p = POS_ESC; p <= POS_RGHT; p++) {
+    if (keymap_key_to_keycode(layer, host_position(p)) == keycode) {
+      *position = p;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Where keycode is on the macOS layers: the FN key to hold (0 for none) and
+// the key to press. The FN layers are the ones the base layer has MO() for.
+static bool find_trigger(uint16_t keycode, uint8_t *fn_position, uint8_t *position) {
+  *fn_position = 0;
+  if (find_on_layer(0, keycode, position)) {
+    return true;
+  }
+
+  for (uint8_t p = POS_ESC; p <= POS_RGHT; p++) {
+    uint16_t base_keycode = keymap_key_to_keycode(0, host_position(p));
+
+    if (base_keycode >= QK_MOMENTARY && base_keycode <= QK_MOMENTARY_MAX &&
+        find_on_layer(base_keycode & 0xFF, keycode, position)) {
+      *fn_position = p;
+      return true;
+    }
+  }
+  return false;
+}
+
+static int8_t first_match(uint16_t trigger, uint8_t mods) {
+  for (uint8_t i = 0; i < mod_override_count; i++) {
+    const mod_override_t *row = &mod_overrides[i];
+
+    if (row->trigger == trigger && (!row->required_mods || (mods & row->required_mods))) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void test_row(uint8_t i) {
+  const mod_override_t *row = &mod_overrides[i];
+  uint8_t               modifier = modifier_for(row->required_mods);
+  uint8_t               held     = modifier ? modifier_keys[modifier - 1].mod : 0;
+  uint8_t               fn_position = 0;
+  uint8_t               position    = POS_NONE;
+
+  CHECK(!row->required_mods || modifier);
+  CHECK(find_trigger(row->trigger, &fn_position, &position));
+  CHECK_EQ(first_match(row->trigger, held), i);
+
+  host_dip_switch_mac = true;
+  host_reset();
+
+  if (modifier) {
+    host_press(modifier_keys[modifier - 1].position);
+  }
+  if (fn_position) {
+    host_press(fn_position);
+  }
+
+  uint32_t before = host_report_count;
+  host_press(position);
+  CHECK_EQ(host_report_count - before, 1);
+
+  const host_report_t *report = &host_reports[host_report_count - 1];
+  if (IS_KEY(row->keycode)) {
+    CHECK_EQ(report->type, HOST_KEYBOARD);
+    CHECK_EQ(report->mods, (held & ~row->suppressed_mods) | row->mods);
+    CHECK(host_report_has_key(report, row->keycode));
+  } else {
+    CHECK(report->type != HOST_KEYBOARD);
+    CHECK(report->usage != 0);
+  }
+
+  before = host_report_count;
+  host_release(position);
+  CHECK_EQ(host_report_count - before, 1);
+
+  report = &host_reports[host_report_count - 1];
+  if (IS_KEY(row->keycode)) {
+    CHECK_EQ(report->mods, held);
+    CHECK(!host_report_has_key(report, row->keycode));
+  } else {
+    CHECK_EQ(report->usage, 0);
+  }
+
+  if (fn_position) {
+    host_release(fn_position);
+  }
+  if (modifier) {
+    host_release(modifier_keys[modifier - 1].position);
+  }
+}
+
+// Letting go of the FN key before the trigger still releases what the
+// press sent, in one report.
+static void test_fn_released_first(uint8_t i) {
+  const mod_override_t *row         = &mod_overrides[i];
+  uint8_t               fn_position = 0;
+  uint8_t               position    = POS_NONE;
+
+  if (!find_trigger(row->trigger, &fn_position, &position) || !fn_position) {
+    return;
+  }
+
+  host_dip_switch_mac = true;
+  host_reset();
+
+  host_press(fn_position);
+  host_press(position);
+  host_release(fn_position);
+
+  uint32_t before = host_report_count;
+  host_release(position);
+  CHECK_EQ(host_report_count - before, 1);
+
+  const host_report_t *report = &host_reports[host_report_count - 1];
+  if (IS_KEY(row->keycode)) {
+    CHECK_EQ(report->mods, 0);
+    CHECK(!host_report_has_key(report, row->keycode));
+  } else {
+    CHECK_EQ(report->usage, 0);
+  }
+}
+
+int main(void) {
+  host_reset();
+  CHECK(mod_override_count > 0);
+
+  for (uint8_t i = 0; i < mod_override_count; i++) {
+    test_row(i);
+    test_fn_released_first(i);
+  }
+
+  return test_result("test_mod_override");
+}
@@ -0,0 +1,82 @@
+// keymap.c is included with its mod_overrides[] renamed, so the rows below
+// take its place and run through its process_record_user().
+#define mod_overrides      keymap_mod_overrides
+#define mod_override_count keymap_mod_override_count
+#include "keymap.c"
+#undef mod_overrides
+#undef mod_override_count
+
+#include "host.h"
+#include "sparse_keymap.h"
+#include "test.h"
+
+// Rows the keymap doesn't have yet: plain keycodes as triggers, and a
+// consumer key as output.
+const mod_override_t mod_overrides[] = {
+  // Home: Cmd-Up
+  {KC_HOME, 0,              0,              KC_UP,   MOD_BIT(KC_LGUI)},
+  // Shift + Page Up: volume up
+  {KC_PGUP, MOD_MASK_SHIFT, MOD_MASK_SHIFT, KC_VOLU, 0},
+};
+
+const uint8_t mod_override_count = sizeof(mod_overrides) / sizeof(mod_overrides[0]);
+
+static void test_plain_trigger(void) {
+  host_reset();
+
+  host_press(POS_HOME);
+  CHECK_EQ(host_report_count, 1);
+  CHECK_EQ(host_last_report()->mods, MOD_BIT(KC_LGUI));
+  CHECK(host_report_has_key(host_last_report(), KC_UP));
+  CHECK(!host_report_has_key(host_last_report(), KC_HOME));
+
+  host_release(POS_HOME);
+  CHECK_EQ(host_report_count, 2);
+  CHECK_EQ(host_last_report()->mods, 0);
+  CHECK(!host_report_has_key(host_last_report(), KC_UP));
+}
+
+static void test_consumer_output(void) {
+  host_reset();
+
+  host_press(POS_LSFT);
+  host_press(POS_PGUP);
+  CHECK_EQ(host_report_count, 2);
+  CHECK_EQ(host_last_report()->type, HOST_CONSUMER);
+  CHECK_EQ(host_last_report()->usage, 0x00E9);
+
+  host_release(POS_PGUP);
+  CHECK_EQ(host_report_count, 3);
+  CHECK_EQ(host_last_report()->type, HOST_CONSUMER);
+  CHECK_EQ(host_last_report()->usage, 0);
+  host_release(POS_LSFT);
+}
+
+// Without Shift, Page Up is left alone, as is everything not in the table.
+static void test_no_match(void) {
+  host_reset();
+
+  host_tap(POS_PGUP);
+  CHECK_EQ(host_report_count, 2);
+  CHECK(host_report_has_key(&host_reports[0], KC_PGUP));
+
+  host_tap(POS_A);
+  CHECK_EQ(host_report_count, 4);
+  CHECK(host_report_has_key(&host_reports[2], KC_A));
+
+  // MAC_EXPOSE has no rows here, so it does nothing.
+  host_press(POS_FN1);
+  host_tap(POS_3);
+  host_release(POS_FN1);
+  CHECK_EQ(host_report_count, 4);
+}
+
+int main(void) {
+  host_dip_switch_mac = true;
+
+  test_plain_trigger();
+  test_consumer_output();
+  test_no_match();
+
+  return test_result("test_mod_override_table");
+}
@@ -0,0 +1,77 @@
+#include "host.h"
+#include "report_batch.h"
+#include "test.h"
+
+// Changes staged with report_batch_*() reach the host as one report per
+// flush, and only when something was staged. A modifier override applies to
+// that one report and leaves the real and weak modifiers as they were.
+// What the overrides built on this send is test_mod_override's business.
+
+// Nothing staged, nothing sent, however often it is flushed.
+static void test_empty_flush(void) {
+  host_reset();
+
+  report_batch_flush();
+  report_batch_flush();
+  CHECK_EQ(host_report_count, 0);
+}
+
+// Everything staged for one event goes out in a single report, and a second
+// flush for the same event sends nothing more.
+static void test_one_report_per_flush(void) {
+  host_reset();
+
+  report_batch_set_mods(MOD_BIT(KC_LCTL));
+  report_batch_add_key(KC_A);
+  report_batch_add_key(KC_B);
+  report_batch_flush();
+  CHECK_EQ(host_report_count, 1);
+  CHECK_EQ(host_last_report()->mods, MOD_BIT(KC_LCTL));
+  CHECK(host_report_has_key(host_last_report(), KC_A));
+  CHECK(host_report_has_key(host_last_report(), KC_B));
+
+  report_batch_flush();
+  CHECK_EQ(host_report_count, 1);
+
+  // A key added and taken away again before the flush never shows up.
+  report_batch_add_key(KC_C);
+  report_batch_del_key(KC_C);
+  report_batch_flush();
+  CHECK_EQ(host_report_count, 2);
+  CHECK(!host_report_has_key(host_last_report(), KC_C));
+
+  report_batch_del_key(KC_A);
+  report_batch_del_key(KC_B);
+  report_batch_flush();
+  CHECK_EQ(host_report_count, 3);
+}
+
+// The override replaces the real and weak modifiers in the flushed report
+// only. Both are back afterwards, and the next report carries them again.
+static void test_mods_restored(void) {
+  host_reset();
+
+  add_mods(MOD_BIT(KC_LSFT));
+  add_weak_mods(MOD_BIT(KC_RALT));
+  report_batch_set_mods(MOD_BIT(KC_LALT));
+  report_batch_add_key(KC_A);
+  report_batch_flush();
+  CHECK_EQ(host_last_report()->mods, MOD_BIT(KC_LALT));
+  CHECK_EQ(get_mods(), MOD_BIT(KC_LSFT));
+  CHECK_EQ(get_weak_mods(), MOD_BIT(KC_RALT));
+
+  clear_weak_mods();
+  report_batch_del_key(KC_A);
+  report_batch_flush();
+  CHECK_EQ(host_report_count, 2);
+  CHECK_EQ(host_last_report()->mods, MOD_BIT(KC_LSFT));
+  clear_mods();
+}
+
+int main(void) {
+  test_empty_flush();
+  test_one_report_per_flush();
+  test_mods_restored();
+
+  return test_result("test_report_batch");
+}
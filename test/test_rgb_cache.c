@@ -0,0 +1,97 @@
+#include <string.h>
+#include "host.h"
+#include "rgb_cache.h"
+#include "sparse_keymap.h"
+#include "test.h"
+
+// RGB keys change the settings in RAM straight away and save them to the
+// simulated EEPROM once, RGB_CACHE_FLUSH_DELAY ms after the last of them.
+
+// Taps an FN1 key count times, 100 ms apart.
+static void tap_fn1(uint8_t position, uint8_t count) {
+  host_press(POS_FN1);
+  for (uint8_t i = 0; i < count; i++) {
+    host_tap(position);
+    host_idle_ms(100);
+  }
+  host_release(POS_FN1);
+}
+
+static void test_hue_steps(void) {
+  host_reset();
+
+  // FN1 + Right is RGB_HUI.
+  tap_fn1(POS_RGHT, 50);
+  CHECK_EQ(host_rgb_config.hue, (uint8_t)(50 * 8));
+  CHECK_EQ(host_eeprom_writes, 0);
+
+  host_idle_ms(RGB_CACHE_FLUSH_DELAY - 200);
+  CHECK_EQ(host_eeprom_writes, 0);
+
+  host_idle_ms(200);
+  CHECK_EQ(host_eeprom_writes, 1);
+  CHECK(memcmp(&host_eeprom_rgb_config, &host_rgb_config, sizeof(host_rgb_config)) == 0);
+
+  // Nothing more to save, however long it sits.
+  host_idle_ms(60000);
+  CHECK_EQ(host_eeprom_writes, 1);
+
+  // It comes back after a power cycle.
+  host_power_cycle();
+  CHECK_EQ(host_rgb_config.hue, (uint8_t)(50 * 8));
+}
+
+// A flush with nothing changed, from the task or on suspend, writes nothing.
+static void test_idle_flush(void) {
+  host_reset();
+
+  host_idle_ms(RGB_CACHE_FLUSH_DELAY * 3);
+  rgb_cache_flush();
+  suspend_power_down_user();
+  CHECK_EQ(host_eeprom_writes, 0);
+  CHECK_EQ(host_eeprom_bytes_written, 0);
+}
+
+// Suspending saves pending changes without waiting for the delay, and
+// only once.
+static void test_suspend(void) {
+  host_reset();
+
+  // FN1 + 6 is RGB_VAI, FN1 + 5 RGB_VAD.
+  tap_fn1(POS_5, 3);
+  suspend_power_down_user();
+  CHECK_EQ(host_eeprom_writes, 1);
+  CHECK_EQ(host_eeprom_rgb_config.val, 255 - 3 * 16);
+
+  host_idle_ms(RGB_CACHE_FLUSH_DELAY * 2);
+  CHECK_EQ(host_eeprom_writes, 1);
+}
+
+// Changes spread over a while are still one write, as long as no gap is as
+// long as the delay. Shift turns each one around.
+static void test_spread_changes(void) {
+  host_reset();
+
+  for (uint8_t i = 0; i < 10; i++) {
+    tap_fn1(POS_RGHT, 1);
+    host_idle_ms(RGB_CACHE_FLUSH_DELAY - 500);
+  }
+  host_press(POS_LSFT);
+  tap_fn1(POS_RGHT, 4);
+  host_release(POS_LSFT);
+  CHECK_EQ(host_eeprom_writes, 0);
+  CHECK_EQ(host_rgb_config.hue, 6 * 8);
+
+  host_idle_ms(RGB_CACHE_FLUSH_DELAY);
+  CHECK_EQ(host_eeprom_writes, 1);
+  CHECK_EQ(host_eeprom_rgb_config.hue, 6 * 8);
+}
+
+int main(void) {
+  test_hue_steps();
+  test_idle_flush();
+  test_suspend();
+  test_spread_changes();
+
+  return test_result("test_rgb_cache");
+}
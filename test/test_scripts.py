@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+
+# Tests for the console decoders in scripts/, run against console output
+# recorded from the host build in data/.
+#
+#   python3 test_scripts.py
+
+import importlib.util
+import os
+import subprocess
+import sys
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SCRIPTS = os.path.join(HERE, "..", "scripts")
+DATA = os.path.join(HERE, "data")
+
+
+def load_script(name):
+    spec = importlib.util.spec_from_file_location(name.replace("-", "_"), os.path.join(SCRIPTS, name + ".py"))
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+
+def run_script(name, stdin_path, *args):
+    with open(stdin_path, "rb") as stdin:
+        return subprocess.run([sys.executable, os.path.join(SCRIPTS, name + ".py")] + list(args), stdin=stdin,
+                              capture_output=True, text=True)
+
+
+def read_data(name):
+    with open(os.path.join(DATA, name)) as f:
+        return f.read()
+
+
+class LatencyStatsTest(unittest.TestCase):
+    def setUp(self):
+        self.script = load_script("latency-stats")
+        self.lines = read_data("latency-console.log").splitlines()
+
+    def test_recorded_console(self):
+        result = run_script("latency-stats", os.path.join(DATA, "latency-console.log"))
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertEqual(result.stdout, read_data("latency-console.expected"))
+
+    def test_decode(self):
+        cycles_per_second, stages = self.script.decode(self.lines[2])
+        self.assertEqual(cycles_per_second, 48000000)
+        self.assertEqual([stage[0] for stage in stages], self.script.STAGES)
+
+        # 22 events, the scan of each taking 120 to 190 us.
+        name, count, low, avg, p99, high = stages[0]
+        self.assertEqual((name, count), ("scan", 22))
+        self.assertEqual((low, high), (120 * 48, 190 * 48))
+        self.assertLessEqual(low, avg)
+        self.assertLessEqual(avg, p99)
+        self.assertLessEqual(p99, high)
+
+    def test_other_lines_ignored(self):
+        for line in self.lines[:2]:
+            self.assertIsNone(self.script.decode(line))
+
+    def test_bad_summaries_ignored(self):
+        self.assertIsNone(self.script.decode("LAT 01ZZ"))
+        self.assertIsNone(self.script.decode("LAT 0105006CDC02"))
+        self.assertIsNone(self.script.decode("LAT " + self.lines[2].split("LAT ")[1][:-2]))
+        self.assertIsNone(self.script.decode("LAT 02" + self.lines[2].split("LAT 01")[1]))
+
+
+class KeyTraceTest(unittest.TestCase):
+    def setUp(self):
+        self.script = load_script("key-trace")
+        self.lines = read_data("key-trace-console.log").splitlines(keepends=True)
+
+    def test_recorded_console(self):
+        result = run_script("key-trace", os.path.join(DATA, "key-trace-console.log"))
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertEqual(result.stdout, read_data("key-trace-console.expected"))
+
+    def test_console_matches_trace_file(self):
+        with open(os.path.join(DATA, "expose-ctrl.k6t"), "rb") as f:
+            self.assertEqual(self.script.read_console(self.lines), f.read())
+
+    def test_bad_hex(self):
+        self.assertIsNone(self.script.read_console(["TRC ZZ\n"]))
+        self.assertIsNone(self.script.read_console(self.lines[:1] + ["TRC ZZ\n"] + self.lines[1:]))
+
+        # A dump after the garbled one still counts.
+        self.assertIsNotNone(self.script.read_console(["TRC ZZ\n", "TRC END\n"] + self.lines))
+
+        result = subprocess.run([sys.executable, os.path.join(SCRIPTS, "key-trace.py")], input="TRC ZZ\n",
+                                capture_output=True, text=True)
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("no complete trace dump", result.stderr)
+
+    def test_bad_trace_file(self):
+        trace = self.script.read_console(self.lines)
+        with self.assertRaises(ValueError):
+            list(self.script.parse(b"K6TR\x02" + trace[5:]))
+        with self.assertRaises(ValueError):
+            list(self.script.parse(trace[:-1]))
+
+    def test_parse(self):
+        events = list(self.script.parse(self.script.read_console(self.lines)))
+        self.assertEqual(len(events), 20)
+        self.assertEqual(events[0], (0, 2, 6, True, 0))
+        self.assertEqual(events[-1], (1970, 4, 11, False, 0))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace_file.h"
+
+static uint8_t *read_file(const char *path, size_t *length) {
+  FILE *file = fopen(path, "rb");
+
+  if (!file) {
+    return NULL;
+  }
+
+  uint8_t *data     = NULL;
+  size_t   capacity = 0;
+
+  *length = 0;
+  for (;;) {
+    if (*length == capacity) {
+      capacity = capacity ? capacity * 2 : 4096;
+
+      uint8_t *grown = realloc(data, capacity);
+
+      if (!grown) {
+        free(data);
+        fclose(file);
+        return NULL;
+      }
+      data = grown;
+    }
+
+    size_t read = fread(data + *length, 1, capacity - *length, file);
+
+    if (read == 0) {
+      break;
+    }
+    *length += read;
+  }
+
+  fclose(file);
+  return data;
+}
+
+uint8_t *trace_file_read(const char *path, uint16_t *count) {
+  size_t   length;
+  uint8_t *trace = read_file(path, &length);
+
+  if (!trace) {
+    perror(path);
+    return NULL;
+  }
+
+  if (length < TRACE_HEADER_BYTES || memcmp(trace, "K6TR", 4) != 0 || trace[4] != TRACE_VERSION) {
+    fprintf(stderr, "%s: not a version %d key trace\n", path, TRACE_VERSION);
+    free(trace);
+    return NULL;
+  }
+
+  *count = trace[5] | trace[6] << 8;
+
+  if (length != TRACE_HEADER_BYTES + (size_t)*count * TRACE_EVENT_BYTES) {
+    fprintf(stderr, "%s: %zu bytes of events, expected %u\n", path, length - TRACE_HEADER_BYTES,
+            *count * TRACE_EVENT_BYTES);
+    free(trace);
+    return NULL;
+  }
+
+  return trace;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+// The trace file format, as key_trace_dump() writes it: "K6TR", the version,
+// the event count (little endian), then TRACE_EVENT_BYTES per event.
+#define TRACE_HEADER_BYTES 7
+#define TRACE_EVENT_BYTES  4
+#define TRACE_VERSION      1
+
+// Reads the trace saved at path and sets *count to its number of events,
+// which start TRACE_HEADER_BYTES into the returned buffer. Returns NULL after
+// printing why to stderr if it can't be read or isn't a valid trace. The
+// caller frees the buffer.
+uint8_t *trace_file_read(const char *path, uint16_t *count);